@@ -7,75 +7,443 @@
 #include <climits>
 #include <algorithm>
 #include <vector>
+#include <array>
+#include <numeric>
+#include <tuple>
+#include <cstring>
+#include <string_view>
+#include <charconv>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <deque>
+#include <unordered_map>
+#include <cstdio>
+#include <filesystem>
+#include <cmath>
+#include <sstream>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#include <io.h>
+#else
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#define SCAN_X86 1
+#include <immintrin.h>
+#endif
 using namespace std;
 
 // Define structs
+struct Node;
+
+// A string in the record store's byte pool: 48-bit offset, 16-bit length
+struct StrRef {
+    uint64_t packed = 0;
+    StrRef() = default;
+    StrRef(uint64_t offset, size_t length) : packed(offset << 16 | min<size_t>(length, 0xFFFF)) {}
+    uint64_t offset() const { return packed >> 16; }
+    size_t length() const { return packed & 0xFFFF; }
+};
+
+int parseExpiryMonths(string_view expiry);
+
+// Record store: one contiguous column per field, indexed by a stable row ID.
+// Rows are never reused; a removed row keeps its data but has no list node.
+// string_views handed out by str() are only valid until the next append.
+struct RecordStore {
+    vector<long long> cardNo;
+    vector<int> pin, billingDate, expiryMonths, creditLimit;
+    vector<StrRef> name, bank, expiryDate;
+    vector<Node*> node;     // list node of each row, nullptr once removed
+    vector<char> bytes;     // shared pool behind every StrRef
+    size_t liveRows = 0;
+
+    int size() const { return (int)cardNo.size(); }
+    size_t bytesUsed() const {
+        return cardNo.capacity() * sizeof(long long)
+             + (pin.capacity() + billingDate.capacity() + expiryMonths.capacity() + creditLimit.capacity()) * sizeof(int)
+             + (name.capacity() + bank.capacity() + expiryDate.capacity()) * sizeof(StrRef)
+             + node.capacity() * sizeof(Node*) + bytes.capacity();
+    }
+    bool isLive(int row) const { return row >= 0 && row < size() && node[row] != nullptr; }
+    string_view str(StrRef ref) const { return string_view(bytes.data() + ref.offset(), ref.length()); }
+
+    StrRef addString(string_view text) {
+        StrRef ref(bytes.size(), text.size());
+        bytes.insert(bytes.end(), text.begin(), text.begin() + ref.length());
+        return ref;
+    }
+    int append(string_view nameText, string_view bankText, string_view expiryText, long long card, int billing, int pinValue, int limit) {
+        cardNo.push_back(card);
+        pin.push_back(pinValue);
+        creditLimit.push_back(limit);
+        billingDate.push_back(billing);
+        expiryMonths.push_back(parseExpiryMonths(expiryText));
+        name.push_back(addString(nameText));
+        bank.push_back(addString(bankText));
+        expiryDate.push_back(addString(expiryText));
+        node.push_back(nullptr);
+        return size() - 1;
+    }
+    void resize(size_t rows, size_t byteCount) {
+        cardNo.resize(rows);
+        pin.resize(rows);
+        creditLimit.resize(rows);
+        billingDate.resize(rows);
+        expiryMonths.resize(rows);
+        name.resize(rows);
+        bank.resize(rows);
+        expiryDate.resize(rows);
+        node.resize(rows, nullptr);
+        bytes.resize(byteCount);
+    }
+    // Copies every row of `part` into rows [rowBase, ...) and bytes [byteBase, ...),
+    // which must already exist; string references are rebased on the way
+    void copyRows(const RecordStore& part, int rowBase, size_t byteBase) {
+        int n = part.size();
+        copy(part.cardNo.begin(), part.cardNo.end(), cardNo.begin() + rowBase);
+        copy(part.pin.begin(), part.pin.end(), pin.begin() + rowBase);
+        copy(part.creditLimit.begin(), part.creditLimit.end(), creditLimit.begin() + rowBase);
+        copy(part.billingDate.begin(), part.billingDate.end(), billingDate.begin() + rowBase);
+        copy(part.expiryMonths.begin(), part.expiryMonths.end(), expiryMonths.begin() + rowBase);
+        copy(part.bytes.begin(), part.bytes.end(), bytes.begin() + byteBase);
+        for (int i = 0; i < n; i++) {
+            name[rowBase + i] = StrRef(part.name[i].offset() + byteBase, part.name[i].length());
+            bank[rowBase + i] = StrRef(part.bank[i].offset() + byteBase, part.bank[i].length());
+            expiryDate[rowBase + i] = StrRef(part.expiryDate[i].offset() + byteBase, part.expiryDate[i].length());
+        }
+    }
+};
+RecordStore store;
+
+// A position in the record list; the record itself lives in `store`
 struct Node {
-    string name, bank, expiryDate;
-    long long cardNo;
-    int pin, billingDate;
+    int row;
     Node* next, *prev;
+    long long cardNo() const { return store.cardNo[row]; }
+    int pin() const { return store.pin[row]; }
+    int billingDate() const { return store.billingDate[row]; }
+    int expiryMonths() const { return store.expiryMonths[row]; }
+    int creditLimit() const { return store.creditLimit[row]; }
+    string_view name() const { return store.str(store.name[row]); }
+    string_view bank() const { return store.str(store.bank[row]); }
+    string_view expiryDate() const { return store.str(store.expiryDate[row]); }
 };
 Node *head = nullptr;
 Node *tail = nullptr;
 
-struct Array {
-    int length = 0;
-    Node** nodes;
-    int index = 0;
-    Array(Node* head) {
-        for (Node* p = head; p; p = p->next) length++;
-        nodes = new Node*[length];
-        index = 0;
-        for (Node* p = head; p; p = p->next) nodes[index++] = p;
-    }
-};
-
 struct BST {
-    Node* node;
+    int row;
     long long cardNo;
     BST* left, *right;
-    BST(Node* n) : node(n), cardNo(n->cardNo), left(nullptr), right(nullptr) {}
+    BST(int r) : row(r), cardNo(store.cardNo[r]), left(nullptr), right(nullptr) {}
 };
 
 struct AVL {
-    Node* node;
-    long long cardNo;
+    int row;
+    long long key;      // card number or expiry month, depending on the tree
     AVL* left, *right;
     int height;
-    AVL(Node* n) : node(n), cardNo(n->cardNo), left(nullptr), right(nullptr), height(1) {}
+    int size;           // nodes in this subtree, for O(log n) range counts
+    AVL(int r, long long k) : row(r), key(k), left(nullptr), right(nullptr), height(1), size(1) {}
 };
 
+// Numeric columns that ordered indexes and heaps can be keyed on
+long long cardKey(int row) { return store.cardNo[row]; }
+long long expiryKey(int row) { return store.expiryMonths[row]; }
+long long creditKey(int row) { return store.creditLimit[row]; }
+long long pinKey(int row) { return store.pin[row]; }
+long long billingKey(int row) { return store.billingDate[row]; }
+
+// Indexed max-heap of live rows ordered by one column (ties: lower row first).
+// position[] records where each row sits, so a row can be added or removed in
+// O(log n), and topK() reads the k largest without popping anything.
 struct Heap {
-    Node** heap;
-    int length;
-    Heap(Node* head) {
-        length = 0;
-        for (Node* p = head; p; p = p->next) length++;
-        heap = new Node*[length];
-        int i = 0;
-        for (Node* p = head; p; p = p->next) heap[i++] = p;
-        for (int i = length / 2 - 1; i >= 0; i--) heapify(i);
-    }
-    ~Heap() { delete[] heap; }
-    void heapify(int i) {
-        int largest = i;
-        int left = 2 * i + 1;
-        int right = 2 * i + 2;
-        if (left < length && heap[left]->cardNo > heap[largest]->cardNo) largest = left;
-        if (right < length && heap[right]->cardNo > heap[largest]->cardNo) largest = right;
-        if (largest != i) {
-            swap(heap[i], heap[largest]);
-            heapify(largest);
-        }
-    }
-    Node* extractMax() {
-        if (length == 0) return nullptr;
-        Node* max = heap[0];
-        heap[0] = heap[length - 1];
-        length--;
-        heapify(0);
-        return max;
+    vector<int> heap;
+    vector<int> position;   // row -> slot in heap, -1 when absent
+    long long (*keyOf)(int row);
+    Heap(long long (*key)(int row)) : keyOf(key) {}
+
+    bool above(int a, int b) const {
+        long long ka = keyOf(a), kb = keyOf(b);
+        return ka > kb || (ka == kb && a < b);
+    }
+    void place(int slot, int row) {
+        heap[slot] = row;
+        position[row] = slot;
+    }
+    void siftUp(int slot) {
+        int row = heap[slot];
+        while (slot > 0 && above(row, heap[(slot - 1) / 2])) {
+            place(slot, heap[(slot - 1) / 2]);
+            slot = (slot - 1) / 2;
+        }
+        place(slot, row);
+    }
+    void heapify(int slot) {
+        int length = heap.size();
+        int row = heap[slot];
+        while (2 * slot + 1 < length) {
+            int child = 2 * slot + 1;
+            if (child + 1 < length && above(heap[child + 1], heap[child])) child++;
+            if (!above(heap[child], row)) break;
+            place(slot, heap[child]);
+            slot = child;
+        }
+        place(slot, row);
+    }
+    void build() {
+        heap.clear();
+        position.assign(store.size(), -1);
+        for (int row = 0; row < store.size(); row++)
+            if (store.node[row]) {
+                position[row] = heap.size();
+                heap.push_back(row);
+            }
+        for (int i = (int)heap.size() / 2 - 1; i >= 0; i--) heapify(i);
+    }
+    // Adopts an array that already satisfies the heap property (a saved heap)
+    void assign(const int* rows, int n) {
+        heap.assign(rows, rows + n);
+        position.assign(store.size(), -1);
+        for (int i = 0; i < n; i++) position[heap[i]] = i;
+    }
+    void insert(int row) {
+        if ((int)position.size() <= row) position.resize(row + 1, -1);
+        heap.push_back(row);
+        siftUp(heap.size() - 1);
+    }
+    void erase(int row) {
+        if (row >= (int)position.size() || position[row] == -1) return;
+        int slot = position[row];
+        position[row] = -1;
+        int last = heap.back();
+        heap.pop_back();
+        if (slot == (int)heap.size()) return;
+        place(slot, last);
+        siftUp(slot);
+        heapify(position[last]);
+    }
+    size_t bytesUsed() const { return (heap.capacity() + position.capacity()) * sizeof(int); }
+    // Row with the largest key, or -1
+    int top() const { return heap.empty() ? -1 : heap[0]; }
+    // The k largest rows, largest first, in O(k log k): a small frontier heap of
+    // slots walks down from the root and only ever holds children of emitted slots
+    vector<int> topK(int k) const {
+        vector<int> rows, frontier;
+        auto lower = [&](int a, int b) { return above(heap[b], heap[a]); };
+        if (!heap.empty() && k > 0) frontier.push_back(0);
+        while (!frontier.empty() && (int)rows.size() < k) {
+            pop_heap(frontier.begin(), frontier.end(), lower);
+            int slot = frontier.back();
+            frontier.pop_back();
+            rows.push_back(heap[slot]);
+            for (int child = 2 * slot + 1; child <= 2 * slot + 2 && child < (int)heap.size(); child++) {
+                frontier.push_back(child);
+                push_heap(frontier.begin(), frontier.end(), lower);
+            }
+        }
+        return rows;
+    }
+};
+//Metrics: one latency histogram per kind of operation, cheap enough to leave on (two
+//clock reads and a few increments per operation). Menu option 31 and the batch query
+//"metrics" print them together with index health gauges.
+enum Operation {
+    OP_PARSE, OP_LOAD_SNAPSHOT, OP_INSERT, OP_REMOVE,
+    OP_SEARCH_BST, OP_SEARCH_AVL, OP_SEARCH_CARD_INDEX, OP_SEARCH_PIN_HASH, OP_SEARCH_PIN_LINEAR,
+    OP_SEARCH_PIN_BINARY, OP_SEARCH_NAME, OP_SEARCH_BANK, OP_RANGE_CARD, OP_RANGE_EXPIRY, OP_TOP_K,
+    OP_SORT_BUBBLE, OP_SORT_SELECTION, OP_SORT_INSERTION, OP_SORT_MERGE, OP_SORT_RADIX, OP_SORT_MULTI,
+    OP_BFS, OP_DFS, OP_DIJKSTRA, OP_PRIM, OP_KRUSKAL,
+    OPERATION_COUNT
+};
+const char* const OPERATION_NAMES[OPERATION_COUNT] = {
+    "parse", "load_snapshot", "insert", "remove",
+    "search_bst", "search_avl", "search_card_index", "search_pin_hash", "search_pin_linear",
+    "search_pin_binary", "search_name", "search_bank", "range_card", "range_expiry", "top_k",
+    "sort_bubble", "sort_selection", "sort_insertion", "sort_merge", "sort_radix", "sort_multi_key",
+    "bfs", "dfs", "dijkstra", "prim", "kruskal"};
+
+// Log-linear histogram in the HDR style: a value (in ns) is bucketed by its highest set
+// bit and the SUB_BITS bits below it, so a bucket is within 1/16 of its values at any
+// magnitude. Values under 16 ns are exact; values past 2^40 ns share the last bucket.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 4, SUB = 1 << SUB_BITS;
+    static constexpr int MAX_BITS = 40;
+    static constexpr int BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB;
+
+private:
+    uint64_t counts[BUCKETS] = {};
+    uint64_t total = 0, sum = 0, largest = 0;
+
+    static int bucketOf(uint64_t ns) {
+        if (ns < SUB) return (int)ns;
+        int shift = 63 - __builtin_clzll(ns) - SUB_BITS;
+        return min(BUCKETS - 1, (shift + 1) * SUB + (int)(ns >> shift) - SUB);
+    }
+    // Largest value that falls in the bucket
+    static uint64_t bucketTop(int bucket) {
+        if (bucket < SUB) return bucket;
+        int shift = bucket / SUB - 1;
+        return ((uint64_t)(bucket % SUB + SUB + 1) << shift) - 1;
+    }
+
+public:
+    // `times` values of `ns` each (a batch timed as a whole records its average)
+    void record(uint64_t ns, uint64_t times = 1) {
+        counts[bucketOf(ns)] += times;
+        total += times;
+        sum += ns * times;
+        largest = max(largest, ns);
+    }
+    uint64_t count() const { return total; }
+    double mean() const { return total ? (double)sum / total : 0; }
+    uint64_t maximum() const { return largest; }
+    // Smallest bucket bound with at least `fraction` of the values at or below it
+    uint64_t percentile(double fraction) const {
+        if (!total) return 0;
+        uint64_t rank = max<uint64_t>(1, (uint64_t)ceil(fraction * total)), seen = 0;
+        for (int bucket = 0; bucket < BUCKETS; bucket++) {
+            seen += counts[bucket];
+            if (seen >= rank) return min(bucketTop(bucket), largest);
+        }
+        return largest;
+    }
+};
+LatencyHistogram latencies[OPERATION_COUNT];
+
+uint64_t nanosSince(chrono::steady_clock::time_point start) {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+}
+// Records the time until the end of its scope under `operation`
+class ScopedTimer {
+    Operation operation;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+public:
+    ScopedTimer(Operation op) : operation(op) {}
+    ~ScopedTimer() { latencies[operation].record(nanosSince(start)); }
+};
+template <typename F>
+auto timed(Operation operation, F fn) {
+    ScopedTimer timer(operation);
+    return fn();
+}
+
+//Pool: slab allocator for fixed-size nodes. Objects are carved out of large
+//slabs and freed objects go on a free list for reuse, so building a structure
+//costs one heap allocation per slab instead of one per node.
+template <typename T, size_t SLAB_SIZE = 4096>
+class Pool {
+    union Cell {
+        Cell* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+    vector<Cell*> slabs;
+    size_t currentSlab = 0;          // slab new cells are bump-allocated from
+    size_t usedInSlab = SLAB_SIZE;   // cells already handed out from it
+    Cell* freeList = nullptr;
+    size_t live = 0;
+    unsigned long long created = 0, reused = 0;
+
+    void nextSlab() {
+        if (!slabs.empty() && currentSlab + 1 < slabs.size()) currentSlab++;
+        else {
+            slabs.push_back(static_cast<Cell*>(::operator new(sizeof(Cell) * SLAB_SIZE)));
+            currentSlab = slabs.size() - 1;
+        }
+        usedInSlab = 0;
+    }
+    // Puts the cells that were never handed out on the free list
+    void freeUnusedCells() {
+        if (slabs.empty()) return;
+        for (size_t s = currentSlab; s < slabs.size(); s++)
+            for (size_t i = (s == currentSlab ? usedInSlab : 0); i < SLAB_SIZE; i++) {
+                slabs[s][i].next = freeList;
+                freeList = &slabs[s][i];
+            }
+        currentSlab = slabs.size() - 1;
+        usedInSlab = SLAB_SIZE;
+    }
+
+public:
+    Pool() = default;
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+    ~Pool() {
+        for (Cell* slab : slabs) ::operator delete(slab);
+    }
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        Cell* cell;
+        if (freeList) {
+            cell = freeList;
+            freeList = freeList->next;
+            reused++;
+        } else {
+            if (usedInSlab == SLAB_SIZE) nextSlab();
+            cell = &slabs[currentSlab][usedInSlab++];
+        }
+        live++;
+        created++;
+        return new (cell->storage) T(std::forward<Args>(args)...);
+    }
+    void destroy(T* object) {
+        if (!object) return;
+        object->~T();
+        Cell* cell = reinterpret_cast<Cell*>(object);
+        cell->next = freeList;
+        freeList = cell;
+        live--;
+    }
+    // Drops every object at once and starts handing out the same slabs again
+    void reset() {
+        static_assert(is_trivially_destructible<T>::value, "reset() would skip destructors");
+        freeList = nullptr;
+        live = 0;
+        currentSlab = 0;
+        usedInSlab = slabs.empty() ? SLAB_SIZE : 0;
+    }
+    // Takes over another pool's slabs and the objects in them (merges per-thread pools)
+    void adopt(Pool& other) {
+        other.freeUnusedCells();
+        while (other.freeList) {
+            Cell* cell = other.freeList;
+            other.freeList = cell->next;
+            cell->next = freeList;
+            freeList = cell;
+        }
+        if (slabs.empty()) {
+            slabs.swap(other.slabs);
+            currentSlab = slabs.size() - 1;
+            usedInSlab = SLAB_SIZE;
+        } else {
+            // Adopted slabs go before ours, so bump allocation carries on where it was
+            slabs.insert(slabs.begin() + currentSlab, other.slabs.begin(), other.slabs.end());
+            currentSlab += other.slabs.size();
+            other.slabs.clear();
+        }
+        live += other.live;
+        created += other.created;
+        reused += other.reused;
+        other.live = 0;
+        other.created = other.reused = 0;
+    }
+
+    struct Stats {
+        size_t slabs, live, capacity, bytes;
+        unsigned long long created, reused;
+    };
+    Stats stats() const {
+        return {slabs.size(), live, slabs.size() * SLAB_SIZE, slabs.size() * SLAB_SIZE * sizeof(Cell), created, reused};
     }
 };
 //Queue
@@ -88,6 +456,11 @@ private:
         Node(T val) : data(val), next(nullptr) {}
     };
     Node *front, *rear;
+    // Never destroyed, so queues living in other statics can still free their cells at exit
+    static Pool<Node>& cells() {
+        static Pool<Node>* pool = new Pool<Node>;
+        return *pool;
+    }
     
 public:
     Queue() : front(nullptr), rear(nullptr) {}
@@ -96,7 +469,7 @@ public:
     }
 
     void enqueue(T val) {
-        Node* newNode = new Node(val);
+        Node* newNode = cells().create(val);
         if (isEmpty()) front = rear = newNode;
         else {
             rear->next = newNode;
@@ -110,7 +483,7 @@ public:
         T val = front->data;
         front = front->next;
         if (!front) rear = nullptr;
-        delete temp;
+        cells().destroy(temp);
         return val;
     }
 
@@ -151,6 +524,10 @@ private:
         StackNode(T val) : data(val), next(nullptr) {}
     };
     StackNode* top;
+    static Pool<StackNode>& cells() {
+        static Pool<StackNode>* pool = new Pool<StackNode>;
+        return *pool;
+    }
 
 public:
     Stack() : top(nullptr) {}
@@ -159,7 +536,7 @@ public:
     }
 
     void push(T val) {
-        StackNode* newNode = new StackNode(val);
+        StackNode* newNode = cells().create(val);
         newNode->next = top;
         top = newNode;
     }
@@ -169,7 +546,7 @@ public:
         StackNode* temp = top;
         T popped = top->data;
         top = top->next;
-        delete temp;
+        cells().destroy(temp);
         return popped;
     }
 
@@ -182,193 +559,353 @@ public:
         return top == nullptr;
     }
 };
-// HashNode structure for chaining
-struct HashNode {
-    Node* data;         
-    HashNode* next;     
-    
-    HashNode(Node* node) : data(node), next(nullptr) {}
-};
 //global varaibles
+Pool<Node> nodePool;
+Pool<BST> bstPool;
+Pool<AVL> avlPool;
 BST* bstRoot = nullptr;
-AVL* avlRoot = nullptr;
-Heap* heap = nullptr;
-const int HASH_SIZE = 1000;
+AVL* avlRoot = nullptr;      // keyed by card number
+AVL* expiryRoot = nullptr;   // keyed by expiry month (year*12+month)
+Heap cardHeap(cardKey);
+Heap creditHeap(creditKey);
 struct History {
-    static Stack<Node*> stack;
+    static Stack<int> stack;   // rows, most recent on top
 };
-Stack<Node*> History::stack;
-// Hash tables
-Node* openAddressingTable[HASH_SIZE] = {nullptr};  // Open addressing
-HashNode* chainTable[HASH_SIZE] = {nullptr};       // Chaining
-//Hashing logic
-int hashFn(int key) {
-    return (key % HASH_SIZE + HASH_SIZE) % HASH_SIZE;
-}
-void insertToOpenAddressing(Node* node) {
-    int idx = hashFn(node->pin);
-    int startIdx = idx;
-    
-    do {
-        if (openAddressingTable[idx] == nullptr) {
-            openAddressingTable[idx] = node;
+Stack<int> History::stack;
+// PIN index: one growable open-addressing table with a control byte per slot
+// (SwissTable style). A control byte is EMPTY, DELETED or the top 7 bits of the
+// key's hash, so most probes are rejected without touching the slot itself.
+// Records sharing a PIN live in one slot: inline when alone, otherwise in a row list
+// from a pool shared by the whole table, whose emptied lists are reused.
+class PinIndex {
+    static constexpr int8_t EMPTY = -128;
+    static constexpr int8_t DELETED = -2;
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    struct Slot {
+        int pin;
+        int count;
+        int ref;               // the row when count == 1, else its list in `groups`
+    };
+
+    vector<int8_t> ctrl;
+    vector<Slot> slots;
+    vector<vector<int>> groups;     // row lists, in insertion order, of shared PINs
+    vector<int> freeGroups;
+    size_t mask = 0;
+    size_t keys = 0;       // distinct PINs
+    size_t records = 0;
+    size_t tombstones = 0;
+
+    static uint64_t hashPin(int pin) {
+        uint64_t h = (uint32_t)pin;
+        h ^= h >> 33; h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33; h *= 0xc4ceb9fe1a85ec53ULL;
+        return h ^ (h >> 33);
+    }
+    static int8_t tag(uint64_t h) { return (int8_t)(h >> 57); }
+    const int* rowsOf(const Slot& slot) const { return slot.count == 1 ? &slot.ref : groups[slot.ref].data(); }
+
+    // Slot holding `pin`, or -1
+    long long findSlot(int pin) const {
+        if (slots.empty()) return -1;
+        uint64_t h = hashPin(pin);
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            if (ctrl[i] == EMPTY) return -1;
+            if (ctrl[i] == tag(h) && slots[i].pin == pin) return i;
+        }
+    }
+    void rehash(size_t capacity) {
+        vector<int8_t> oldCtrl(capacity, EMPTY);
+        vector<Slot> oldSlots(capacity);
+        oldCtrl.swap(ctrl);
+        oldSlots.swap(slots);
+        mask = capacity - 1;
+        tombstones = 0;
+        for (size_t i = 0; i < oldSlots.size(); i++) {
+            if (oldCtrl[i] < 0) continue;
+            uint64_t h = hashPin(oldSlots[i].pin);
+            size_t j = h & mask;
+            while (ctrl[j] != EMPTY) j = (j + 1) & mask;
+            ctrl[j] = tag(h);
+            slots[j] = oldSlots[i];
+        }
+    }
+    // Keeps (keys + tombstones) at or under 3/4 of the capacity
+    void reserveOneMore() {
+        size_t capacity = slots.size();
+        if (capacity && (keys + tombstones + 1) * 4 <= capacity * 3) return;
+        if (capacity && (keys + 1) * 2 <= capacity) rehash(capacity);   // mostly tombstones
+        else rehash(max(MIN_CAPACITY, capacity * 2));
+    }
+
+public:
+    size_t size() const { return records; }
+    size_t distinctPins() const { return keys; }
+    size_t capacity() const { return slots.size(); }
+    size_t bytesUsed() const {
+        size_t total = ctrl.capacity() + slots.capacity() * sizeof(Slot)
+                     + groups.capacity() * sizeof(vector<int>) + freeGroups.capacity() * sizeof(int);
+        for (const vector<int>& rows : groups) total += rows.capacity() * sizeof(int);
+        return total;
+    }
+
+    void clear() {
+        ctrl.clear();
+        slots.clear();
+        groups.clear();
+        freeGroups.clear();
+        mask = keys = records = tombstones = 0;
+    }
+    void insert(int row) {
+        int pin = store.pin[row];
+        long long found = findSlot(pin);
+        records++;
+        if (found >= 0) {
+            Slot& slot = slots[found];
+            if (slot.count == 1) {
+                int group;
+                if (freeGroups.empty()) {
+                    group = (int)groups.size();
+                    groups.emplace_back();
+                } else {
+                    group = freeGroups.back();
+                    freeGroups.pop_back();
+                }
+                groups[group].push_back(slot.ref);
+                slot.ref = group;
+            }
+            groups[slot.ref].push_back(row);
+            slot.count++;
             return;
         }
-        idx = (idx + 1) % HASH_SIZE;
-    } while (idx != startIdx);
-    
-    cout << "Open Addressing Table Full! Couldn't insert PIN: " 
-         << node->pin << "\n";
-}
-Node* searchOpenAddressing(int pin) {
-    int idx = hashFn(pin);
-    int startIdx = idx;
-    
-    do {
-        if (openAddressingTable[idx] && openAddressingTable[idx]->pin == pin) {
-            return openAddressingTable[idx];
+        reserveOneMore();
+        uint64_t h = hashPin(pin);
+        size_t i = h & mask;
+        while (ctrl[i] >= 0) i = (i + 1) & mask;
+        if (ctrl[i] == DELETED) tombstones--;
+        ctrl[i] = tag(h);
+        slots[i] = {pin, 1, row};
+        keys++;
+    }
+    void erase(int row) {
+        long long found = findSlot(store.pin[row]);
+        if (found < 0) return;
+        Slot& slot = slots[found];
+        if (slot.count == 1) {
+            if (slot.ref != row) return;
+            ctrl[found] = DELETED;
+            tombstones++;
+            keys--;
+            records--;
+            return;
         }
-        if (openAddressingTable[idx] == nullptr) break;  // Stop at empty slot
-        idx = (idx + 1) % HASH_SIZE;
-    } while (idx != startIdx);
-    
-    return nullptr;
-}
-void insertToChainTable(Node* node) {
-    int idx = hashFn(node->pin);
-    HashNode* newHashNode = new HashNode(node);
-    
-    newHashNode->next = chainTable[idx];
-    chainTable[idx] = newHashNode;
-}
-Node* searchInChain(int pin) {
-    int idx = hashFn(pin);
-    HashNode* current = chainTable[idx];
-    
-    while (current != nullptr) {
-        if (current->data->pin == pin) {
-            return current->data;
+        vector<int>& rows = groups[slot.ref];
+        auto it = std::find(rows.begin(), rows.end(), row);
+        if (it == rows.end()) return;
+        rows.erase(it);
+        records--;
+        if (--slot.count == 1) {
+            int last = rows.front();
+            rows.clear();
+            freeGroups.push_back(slot.ref);
+            slot.ref = last;
         }
-        current = current->next;
     }
-    return nullptr;
-}
-void rebuildHashTables() {
-    for (int i = 0; i < HASH_SIZE; i++) {
-        openAddressingTable[i] = nullptr;
+    // First row inserted with this PIN, or -1
+    int find(int pin) const {
+        long long found = findSlot(pin);
+        return found < 0 ? -1 : *rowsOf(slots[found]);
     }
-    for (int i = 0; i < HASH_SIZE; i++) {
-        HashNode* current = chainTable[i];
-        while (current != nullptr) {
-            HashNode* temp = current;
-            current = current->next;
-            delete temp;
-        }
-        chainTable[i] = nullptr;
+    // All rows with this PIN in insertion order; returns how many
+    int findAll(int pin, const int** out) const {
+        long long found = findSlot(pin);
+        if (found < 0) return 0;
+        *out = rowsOf(slots[found]);
+        return slots[found].count;
     }
-    Node* current = head;
-    while (current != nullptr) {
-        insertToOpenAddressing(current);
-        insertToChainTable(current);
-        current = current->next;
+
+    template <typename F>
+    void forEachSlot(F fn) const {
+        for (size_t i = 0; i < slots.size(); i++)
+            if (ctrl[i] >= 0) fn(i, slots[i].pin, rowsOf(slots[i]), slots[i].count);
+    }
+
+    struct Stats {
+        size_t capacity, keys, records, tombstones;
+        size_t longestProbe, totalProbe, largestGroup;
+        vector<size_t> probeLengths;   // [i]: keys reached in i + 1 probes
+    };
+    // Probe length is the number of slots visited to reach a key from its home slot
+    Stats stats() const {
+        Stats st{slots.size(), keys, records, tombstones, 0, 0, 0, {}};
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (ctrl[i] < 0) continue;
+            size_t probe = ((i - (hashPin(slots[i].pin) & mask)) & mask) + 1;
+            if (st.probeLengths.size() < probe) st.probeLengths.resize(probe, 0);
+            st.probeLengths[probe - 1]++;
+            st.longestProbe = max(st.longestProbe, probe);
+            st.totalProbe += probe;
+            st.largestGroup = max(st.largestGroup, (size_t)slots[i].count);
+        }
+        return st;
     }
+};
+PinIndex pinIndex;
+
+void rebuildHashTables() {
+    pinIndex.clear();
+    for (Node* p = head; p; p = p->next) pinIndex.insert(p->row);
 }
-void displayOpenAddressing() {
-    cout << "\nOpen Addressing Hash Table Contents:\n";
-    cout << "Index\tPIN\tName\n";
-    cout << "----------------------------\n";
-    
-    int count = 0;
-    for (int i = 0; i < HASH_SIZE; i++) {
-        if (openAddressingTable[i] != nullptr) {
-            cout << i << "\t" 
-                 << openAddressingTable[i]->pin << "\t"
-                 << openAddressingTable[i]->name << "\n";
-            count++;
+vector<int> sortedRows(long long (*keyOf)(int row));
+
+// Sorted-by-PIN view for binary search: the live rows ordered by (PIN, row), built on
+// first use by the radix engine. Changes are only noted; the next lookup patches them in
+// (new rows merged, removed ones dropped in one pass), or rebuilds when more than an
+// eighth of the view has changed.
+class PinView {
+    vector<int> rows;
+    vector<int> added;
+    size_t removed = 0;
+    bool built = false;
+
+    static bool before(int a, int b) { return store.pin[a] < store.pin[b] || (store.pin[a] == store.pin[b] && a < b); }
+
+public:
+    void invalidate() {
+        built = false;
+        added.clear();
+        removed = 0;
+    }
+    void add(int row) { if (built) added.push_back(row); }
+    void remove() { if (built) removed++; }
+    size_t bytesUsed() const { return (rows.capacity() + added.capacity()) * sizeof(int); }
+
+    const vector<int>& sorted() {
+        if (built && (added.size() + removed) * 8 > rows.size()) built = false;
+        if (!built) {
+            rows = sortedRows(pinKey);
+            built = true;
+        } else {
+            auto dead = [](int row) { return !store.node[row]; };
+            if (removed) rows.erase(remove_if(rows.begin(), rows.end(), dead), rows.end());
+            added.erase(remove_if(added.begin(), added.end(), dead), added.end());
+            sort(added.begin(), added.end(), before);
+            size_t middle = rows.size();
+            rows.insert(rows.end(), added.begin(), added.end());
+            inplace_merge(rows.begin(), rows.begin() + middle, rows.end(), before);
         }
+        added.clear();
+        removed = 0;
+        return rows;
     }
-    
-    if (count == 0) {
-        cout << "Hash table is empty\n";
+};
+PinView pinView;
+
+void displayPinIndex() {
+    cout << "\nPIN Hash Index Contents:\n";
+    cout << "Slot\tPIN\tName\n";
+    cout << "----------------------------\n";
+    pinIndex.forEachSlot([](size_t slot, int pin, const int* rows, int count) {
+        cout << slot << "\t" << pin << "\t" << store.str(store.name[rows[0]]);
+        for (int i = 1; i < count; i++) cout << ", " << store.str(store.name[rows[i]]);
+        cout << "\n";
+    });
+    if (pinIndex.size() == 0) {
+        cout << "Hash index is empty\n";
     } else {
         cout << "----------------------------\n";
-        cout << "Total entries: " << count << "\n";
+        cout << "Total entries: " << pinIndex.size() << "\n";
     }
 }
-void displayChainTable() {
-    cout << "\nChaining Hash Table Contents:\n";
-    cout << "Index\tChain Contents\n";
+void displayPinIndexStats() {
+    PinIndex::Stats st = pinIndex.stats();
+    cout << "\nPIN Hash Index Statistics:\n";
     cout << "------------------------------------------------\n";
-    
-    int totalEntries = 0;
-    int nonEmptyBuckets = 0;
-    int maxChainLength = 0;
-    
-    for (int i = 0; i < HASH_SIZE; i++) {
-        if (chainTable[i] != nullptr) {
-            nonEmptyBuckets++;
-            int chainLength = 0;
-            
-            cout << i << "\t";
-            HashNode* current = chainTable[i];
-            while (current != nullptr) {
-                cout << current->data->pin << " (" 
-                     << current->data->name << ") -> ";
-                current = current->next;
-                chainLength++;
-            }
-            cout << "NULL\n";
-            
-            totalEntries += chainLength;
-            if (chainLength > maxChainLength) {
-                maxChainLength = chainLength;
-            }
-        }
-    }
-    
-    if (nonEmptyBuckets == 0) {
-        cout << "Hash table is empty\n";
-    } else {
-        cout << "------------------------------------------------\n";
-        cout << "Total entries: " << totalEntries << "\n";
-        cout << "Non-empty buckets: " << nonEmptyBuckets << "\n";
-        cout << "Load factor: " << (float)totalEntries/HASH_SIZE << "\n";
-        cout << "Longest chain: " << maxChainLength << "\n";
-    }
+    cout << "Total entries: " << st.records << "\n";
+    cout << "Distinct PINs: " << st.keys << "\n";
+    cout << "Capacity: " << st.capacity << " slots\n";
+    cout << "Tombstones: " << st.tombstones << "\n";
+    cout << "Load factor: " << (st.capacity ? (float)(st.keys + st.tombstones) / st.capacity : 0.0f) << "\n";
+    cout << "Longest probe: " << st.longestProbe << "\n";
+    cout << "Average probe: " << (st.keys ? (float)st.totalProbe / st.keys : 0.0f) << "\n";
+    cout << "Most cards sharing a PIN: " << st.largestGroup << "\n";
 }
 // Operations on BST
-BST* insertBST(BST* root, Node* node) {
-    if (!root) return new BST(node);
-    if (node->cardNo < root->cardNo) root->left = insertBST(root->left, node);
-    else if (node->cardNo > root->cardNo) root->right = insertBST(root->right, node);
+// One node per distinct card number; a repeated card keeps the row seen first
+BST* insertBST(BST* root, int row) {
+    if (!root) return bstPool.create(row);
+    if (store.cardNo[row] < root->cardNo) root->left = insertBST(root->left, row);
+    else if (store.cardNo[row] > root->cardNo) root->right = insertBST(root->right, row);
     return root;
 }
 
 BST* buildBST() {
     BST* root = nullptr;
-    for (Node* p = head; p; p = p->next) root = insertBST(root, p);
+    for (int row = 0; row < store.size(); row++)
+        if (store.node[row]) root = insertBST(root, row);
     return root;
 }
 
-Node* searchBST(BST* root, long long cardNo) {
+// Balanced BST over rows sorted by (cardNo, row), keeping the first row of each card
+BST* buildBSTSorted(const int* rows, int n) {
+    if (n <= 0) return nullptr;
+    int mid = n / 2;
+    while (mid > 0 && store.cardNo[rows[mid - 1]] == store.cardNo[rows[mid]]) mid--;
+    int end = mid + 1;
+    while (end < n && store.cardNo[rows[end]] == store.cardNo[rows[mid]]) end++;
+    BST* node = bstPool.create(rows[mid]);
+    node->left = buildBSTSorted(rows, mid);
+    node->right = buildBSTSorted(rows + end, n - end);
+    return node;
+}
+
+// Unlinks the node for `cardNo` (caller must still own it) and returns the new subtree root
+BST* removeBST(BST* root, long long cardNo) {
     if (!root) return nullptr;
-    if (cardNo == root->cardNo) return root->node;
+    if (cardNo < root->cardNo) root->left = removeBST(root->left, cardNo);
+    else if (cardNo > root->cardNo) root->right = removeBST(root->right, cardNo);
+    else {
+        BST* child = root->left ? root->left : root->right;
+        if (!root->left || !root->right) {
+            bstPool.destroy(root);
+            return child;
+        }
+        BST* successor = root->right;
+        while (successor->left) successor = successor->left;
+        root->row = successor->row;
+        root->cardNo = successor->cardNo;
+        root->right = removeBST(root->right, successor->cardNo);
+    }
+    return root;
+}
+
+// Row holding the card, or -1
+int searchBST(BST* root, long long cardNo) {
+    if (!root) return -1;
+    if (cardNo == root->cardNo) return root->row;
     if (cardNo < root->cardNo) return searchBST(root->left, cardNo);
     return searchBST(root->right, cardNo);
 }
 
 // Operations on AVL
 int height(AVL* node) { return node ? node->height : 0; }
+int size(AVL* node) { return node ? node->size : 0; }
 
 int balanceFactor(AVL* node) { return node ? height(node->left) - height(node->right) : 0; }
 
+void update(AVL* node) {
+    node->height = max(height(node->left), height(node->right)) + 1;
+    node->size = size(node->left) + size(node->right) + 1;
+}
+
 AVL* rotateRight(AVL* y) {
     AVL* x = y->left;
     AVL* T2 = x->right;
     x->right = y;
     y->left = T2;
-    y->height = max(height(y->left), height(y->right)) + 1;
-    x->height = max(height(x->left), height(x->right)) + 1;
+    update(y);
+    update(x);
     return x;
 }
 
@@ -377,182 +914,735 @@ AVL* rotateLeft(AVL* x) {
     AVL* T2 = y->left;
     y->left = x;
     x->right = T2;
-    x->height = max(height(x->left), height(x->right)) + 1;
-    y->height = max(height(y->left), height(y->right)) + 1;
+    update(x);
+    update(y);
     return y;
 }
 
-AVL* insertAVL(AVL* node, Node* n) {
-    if (!node) return new AVL(n);
-    if (n->cardNo < node->cardNo) node->left = insertAVL(node->left, n);
-    else if (n->cardNo > node->cardNo) node->right = insertAVL(node->right, n);
-    else return node;
+// Each tree holds every live row, ordered by (key, row), so repeated keys each keep a node
 
-    node->height = 1 + max(height(node->left), height(node->right));
-    int balance = balanceFactor(node);
+bool lessAVL(long long key, int row, const AVL* node) {
+    return key < node->key || (key == node->key && row < node->row);
+}
 
-    if (balance > 1 && n->cardNo < node->left->cardNo) return rotateRight(node);
-    if (balance < -1 && n->cardNo > node->right->cardNo) return rotateLeft(node);
-    if (balance > 1 && n->cardNo > node->left->cardNo) {
-        node->left = rotateLeft(node->left);
+AVL* rebalance(AVL* node) {
+    update(node);
+    int balance = balanceFactor(node);
+    if (balance > 1) {
+        if (balanceFactor(node->left) < 0) node->left = rotateLeft(node->left);
         return rotateRight(node);
     }
-    if (balance < -1 && n->cardNo < node->right->cardNo) {
-        node->right = rotateRight(node->right);
+    if (balance < -1) {
+        if (balanceFactor(node->right) > 0) node->right = rotateRight(node->right);
         return rotateLeft(node);
     }
     return node;
 }
 
-AVL* buildAVL() {
+AVL* insertAVL(AVL* node, int row, long long key) {
+    if (!node) return avlPool.create(row, key);
+    if (lessAVL(key, row, node)) node->left = insertAVL(node->left, row, key);
+    else if (row != node->row) node->right = insertAVL(node->right, row, key);
+    else return node;
+    return rebalance(node);
+}
+
+// Detaches the leftmost node of the subtree into `min`
+AVL* removeMinAVL(AVL* node, AVL*& min) {
+    if (!node->left) {
+        min = node;
+        return node->right;
+    }
+    node->left = removeMinAVL(node->left, min);
+    return rebalance(node);
+}
+
+AVL* removeAVL(AVL* node, int row, long long key) {
+    if (!node) return nullptr;
+    if (row == node->row) {
+        AVL* left = node->left;
+        AVL* right = node->right;
+        avlPool.destroy(node);
+        if (!right) return left;
+        AVL* successor;
+        right = removeMinAVL(right, successor);
+        successor->left = left;
+        successor->right = right;
+        return rebalance(successor);
+    }
+    if (lessAVL(key, row, node)) node->left = removeAVL(node->left, row, key);
+    else node->right = removeAVL(node->right, row, key);
+    return rebalance(node);
+}
+
+AVL* buildAVL(long long (*keyOf)(int row) = cardKey) {
     AVL* root = nullptr;
-    for (Node* p = head; p; p = p->next) root = insertAVL(root, p);
+    for (int row = 0; row < store.size(); row++)
+        if (store.node[row]) root = insertAVL(root, row, keyOf(row));
     return root;
 }
 
-Node* searchAVL(AVL* root, long long cardNo) {
-    if (!root) return nullptr;
-    if (cardNo == root->cardNo) return root->node;
-    if (cardNo < root->cardNo) return searchAVL(root->left, cardNo);
-    return searchAVL(root->right, cardNo);
+// Perfectly balanced tree over rows already sorted by (key, row), in O(n)
+AVL* buildAVLSorted(const int* rows, int n, long long (*keyOf)(int row)) {
+    if (n <= 0) return nullptr;
+    int mid = n / 2;
+    AVL* node = avlPool.create(rows[mid], keyOf(rows[mid]));
+    node->left = buildAVLSorted(rows, mid, keyOf);
+    node->right = buildAVLSorted(rows + mid + 1, n - mid - 1, keyOf);
+    update(node);
+    return node;
 }
 
-// Graph Utilities
-vector<Node*> getNodesByBank(const string& bank) {
-    vector<Node*> nodes;
-    for (Node* p = head; p; p = p->next)
-        if (p->bank == bank) nodes.push_back(p);
-    return nodes;
+// Lowest row holding the key, or -1
+int searchAVL(AVL* root, long long key) {
+    if (!root) return -1;
+    if (key < root->key) return searchAVL(root->left, key);
+    if (key > root->key) return searchAVL(root->right, key);
+    int left = searchAVL(root->left, key);
+    return left != -1 ? left : root->row;
 }
 
-int expiryToMonths(const string& expiry) {
-    int month = stoi(expiry.substr(0, 2));
-    int year = stoi(expiry.substr(3, 2));
-    return year * 12 + month;
-}
-vector<vector<int>> buildBankGraph(const vector<Node*>& nodes) {
-    int n = nodes.size();
-    vector<vector<int>> adj(n);
-    if (n <= 1) return adj; 
-    for (int i = 0; i < n; i++) {
-        int next = (i + 1) % n;
-        adj[i].push_back(next);
-        adj[next].push_back(i);
-        int prev = (i - 1 + n) % n;
-        adj[i].push_back(prev);
-        adj[prev].push_back(i);
+// Number of nodes with a key below `key`
+int rankAVL(AVL* root, long long key) {
+    int rank = 0;
+    while (root) {
+        if (root->key < key) {
+            rank += size(root->left) + 1;
+            root = root->right;
+        } else root = root->left;
     }
-    return adj;
+    return rank;
 }
-void printBFS(const vector<Node*>& nodes) {
-    if (nodes.empty()) return;
-    
-    vector<vector<int>> adj = buildBankGraph(nodes);
-    int n = nodes.size();
-    vector<bool> visited(n, false);
-    Queue<int> q;  // Using our custom Queue
-    
-    // Start from first node
-    q.enqueue(0);
-    visited[0] = true;
-    
-    cout << "BFS Traversal:\n";
-    while (!q.isEmpty()) {
-        int u = q.dequeue();
-        cout << nodes[u]->name << " (" << nodes[u]->cardNo << ") -> ";
-        
-        for (int v : adj[u]) {
-            if (!visited[v]) {
-                visited[v] = true;
-                q.enqueue(v);
-            }
-        }
-    }
-    cout << "END\n";
+
+// Rows with lo <= key <= hi, counted without visiting them
+int countAVL(AVL* root, long long lo, long long hi) {
+    if (lo > hi) return 0;
+    int below = rankAVL(root, lo);
+    return hi == LLONG_MAX ? size(root) - below : rankAVL(root, hi + 1) - below;
 }
-void printDFS(const vector<Node*>& nodes) {
-    if (nodes.empty()) return;
-    
-    vector<vector<int>> adj = buildBankGraph(nodes);
-    int n = nodes.size();
-    vector<bool> visited(n, false);
-    Stack<int> st;  // Using our custom Stack
-    
-    // Start from first node
-    st.push(0);
-    visited[0] = true;
-    
-    cout << "DFS Traversal:\n";
-    while (!st.isEmpty()) {
-        int u = st.pop();
-        cout << nodes[u]->name << " (" << nodes[u]->cardNo << ") -> ";
-        
-        // Process neighbors in reverse order for DFS correctness
-        for (int i = adj[u].size()-1; i >= 0; i--) {
-            int v = adj[u][i];
-            if (!visited[v]) {
-                visited[v] = true;
-                st.push(v);
+
+// In-order cursor over the rows with lo <= key <= hi. It holds only the path to the
+// current node, so a range is streamed without building the result:
+//     for (AVLRange range(avlRoot, lo, hi); range.valid(); range.next()) use(range.row());
+class AVLRange {
+    vector<AVL*> path;  // nodes still to visit, the current one on top
+    long long hi;
+
+    void pushLeft(AVL* node, long long lo) {
+        while (node) {
+            if (node->key < lo) node = node->right;
+            else {
+                path.push_back(node);
+                node = node->left;
             }
         }
     }
-    cout << "END\n";
-}
 
-long long dijkstraPath(const vector<Node*>& nodes, long long srcCard, long long destCard) {
-    int n = nodes.size();
-    vector<vector<long long>> graph(n, vector<long long>(n, 0));
-    int srcIdx = -1, destIdx = -1;
+public:
+    AVLRange(AVL* root, long long lo, long long hi) : hi(hi) {
+        path.reserve(2 * height(root));
+        pushLeft(root, lo);
+        if (!path.empty() && path.back()->key > hi) path.clear();
+    }
+    bool valid() const { return !path.empty(); }
+    int row() const { return path.back()->row; }
+    long long key() const { return path.back()->key; }
+    void next() {
+        AVL* node = path.back();
+        path.pop_back();
+        pushLeft(node->right, LLONG_MIN);
+        if (!path.empty() && path.back()->key > hi) path.clear();
+    }
+};
 
-    for (int i = 0; i < n; i++) {
-        if (nodes[i]->cardNo == srcCard) srcIdx = i;
-        if (nodes[i]->cardNo == destCard) destIdx = i;
-        for (int j = 0; j < n; j++) {
-            if (i == j) continue;
-            int diff = abs(expiryToMonths(nodes[i]->expiryDate) - expiryToMonths(nodes[j]->expiryDate));
-            graph[i][j] = diff;
+// Read-optimized card index: the (cardNo, row) pairs in Eytzinger order (a complete
+// binary tree laid out breadth-first in one array), so the top levels share cache lines
+// and the next levels can be prefetched. A change only marks it stale: a rebuild walks
+// the whole AVL (O(n)), so until then lookups go to the AVL tree (O(log n), a cache miss
+// per level). It is rebuilt once the lookups since the change reach n / REBUILD_RATIO,
+// so each rebuild is paid for by the reads it speeds up. Read-heavy workloads get the
+// array; a stream of changes mixed with lookups stays on the tree.
+class CardIndex {
+    static constexpr size_t REBUILD_RATIO = 32;
+    vector<long long> keys;     // 1-based; keys[0] is unused
+    vector<int> rows;
+    int count = 0;
+    bool dirty = true;
+    size_t staleLookups = 0;    // lookups served by the AVL since the index went stale
+
+    void collect(AVL* node, vector<int>& sorted) {
+        if (!node) return;
+        collect(node->left, sorted);
+        sorted.push_back(node->row);
+        collect(node->right, sorted);
+    }
+    void place(const vector<int>& sorted, int& next, int k) {
+        if (k > count) return;
+        place(sorted, next, 2 * k);
+        rows[k] = sorted[next++];
+        keys[k] = store.cardNo[rows[k]];
+        place(sorted, next, 2 * k + 1);
+    }
+    void build() {
+        vector<int> sorted;
+        sorted.reserve(store.liveRows);
+        collect(avlRoot, sorted);
+        count = (int)sorted.size();
+        keys.assign(count + 1, 0);
+        rows.assign(count + 1, -1);
+        int next = 0;
+        place(sorted, next, 1);
+        dirty = false;
+    }
+    // Slot of the first key >= cardNo, or 0 when there is none. Branch-free descent; the
+    // prefetch pulls in the 16 descendants four levels down.
+    int lowerBound(long long cardNo) const {
+        int k = 1;
+        while (k <= count) {
+            __builtin_prefetch(keys.data() + min(16 * k, count));
+            k = 2 * k + (keys[k] < cardNo);
         }
+        return k >> __builtin_ffs(~k);
+    }
+    // Counts `lookups` against a stale index; true once it has been rebuilt for them
+    bool catchUp(size_t lookups) {
+        staleLookups += lookups;
+        if (staleLookups * REBUILD_RATIO < store.liveRows) return false;
+        build();
+        return true;
     }
 
-    if (srcIdx == -1 || destIdx == -1) return -1;
-
-    vector<long long> dist(n, LLONG_MAX);
-    vector<bool> visited(n, false);
-    dist[srcIdx] = 0;
+public:
+    void invalidate() {
+        if (!dirty) staleLookups = 0;
+        dirty = true;
+    }
+    bool stale() const { return dirty; }
+    int size() { if (dirty) build(); return count; }
+    size_t bytesUsed() const { return keys.capacity() * sizeof(long long) + rows.capacity() * sizeof(int); }
 
-    for (int count = 0; count < n - 1; count++) {
-        long long minDist = LLONG_MAX;
-        int u = -1;
-        for (int i = 0; i < n; i++) {
-            if (!visited[i] && dist[i] < minDist) {
-                minDist = dist[i];
-                u = i;
-            }
+    // Lowest live row holding the card, or -1
+    int find(long long cardNo) {
+        if (dirty && !catchUp(1)) return searchAVL(avlRoot, cardNo);
+        int k = lowerBound(cardNo);
+        return (k && keys[k] == cardNo) ? rows[k] : -1;
+    }
+    // Looks up `n` cards, interleaving BATCH descents so their cache misses overlap
+    static constexpr int BATCH = 16;
+    void findBatch(const long long* cardNos, int n, int* out) {
+        if (dirty && !catchUp(n)) {
+            for (int i = 0; i < n; i++) out[i] = searchAVL(avlRoot, cardNos[i]);
+            return;
         }
-        if (u == -1) break;
-        visited[u] = true;
-        for (int v = 0; v < n; v++) {
-            if (!visited[v] && graph[u][v] && dist[u] != LLONG_MAX && dist[u] + graph[u][v] < dist[v]) {
-                dist[v] = dist[u] + graph[u][v];
+        for (int base = 0; base < n; base += BATCH) {
+            int width = min(BATCH, n - base);
+            int k[BATCH];
+            for (int i = 0; i < width; i++) k[i] = 1;
+            for (int level = 1; level <= count; level *= 2) {
+                for (int i = 0; i < width; i++) {
+                    if (k[i] > count) continue;
+                    __builtin_prefetch(keys.data() + min(16 * k[i], count));
+                    k[i] = 2 * k[i] + (keys[k[i]] < cardNos[base + i]);
+                }
+            }
+            for (int i = 0; i < width; i++) {
+                int slot = k[i] >> __builtin_ffs(~k[i]);
+                out[base + i] = (slot && keys[slot] == cardNos[base + i]) ? rows[slot] : -1;
             }
         }
     }
-    return dist[destIdx];
-}
+};
+CardIndex cardIndex;
 
-long long primMST(const vector<Node*>& nodes) {
-    int n = nodes.size();
-    if (n == 0) return 0;
+// Graph Utilities
+// Bank index: each issuing bank is interned to a small ID with a posting list of
+// its live rows in ascending row order, so a per-bank query only touches its own rows
+class BankIndex {
+    deque<string> names;                      // deque keeps the map's keys in place
+    unordered_map<string_view, int> ids;
+    vector<vector<int>> postings;
+    vector<int> bankOfRow;
+    vector<unsigned> versions;                // bumped whenever a bank's postings change
 
-    vector<vector<long long>> graph(n, vector<long long>(n, 0));
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            if (i == j) continue;
-            graph[i][j] = abs(nodes[i]->billingDate - nodes[j]->billingDate);
-        }
+public:
+    int intern(string_view bank) {
+        auto it = ids.find(bank);
+        if (it != ids.end()) return it->second;
+        names.emplace_back(bank);
+        postings.emplace_back();
+        versions.push_back(0);
+        return ids[names.back()] = (int)names.size() - 1;
+    }
+    int find(string_view bank) const {
+        auto it = ids.find(bank);
+        return it == ids.end() ? -1 : it->second;
+    }
+    int bankCount() const { return (int)names.size(); }
+    const string& name(int id) const { return names[id]; }
+    const vector<int>& rows(int id) const { return postings[id]; }
+    int bankOf(int row) const { return bankOfRow[row]; }
+    unsigned version(int id) const { return versions[id]; }
+    size_t bytesUsed() const {
+        size_t total = (bankOfRow.capacity() + versions.capacity()) * sizeof(int) + ids.size() * (sizeof(string_view) + sizeof(int) + 2 * sizeof(void*));
+        for (const string& name : names) total += sizeof(string) + name.capacity();
+        for (const vector<int>& list : postings) total += sizeof(vector<int>) + list.capacity() * sizeof(int);
+        return total;
     }
 
-    vector<long long> key(n, LLONG_MAX);
+    void insert(int row) {
+        int id = intern(store.str(store.bank[row]));
+        if ((int)bankOfRow.size() <= row) bankOfRow.resize(row + 1, -1);
+        bankOfRow[row] = id;
+        versions[id]++;
+        vector<int>& list = postings[id];
+        if (list.empty() || list.back() < row) list.push_back(row);
+        else list.insert(lower_bound(list.begin(), list.end(), row), row);
+    }
+    void erase(int row) {
+        versions[bankOfRow[row]]++;
+        vector<int>& list = postings[bankOfRow[row]];
+        auto it = lower_bound(list.begin(), list.end(), row);
+        if (it != list.end() && *it == row) list.erase(it);
+    }
+    // Bank IDs stay as they are so handed-out IDs remain valid; only the postings are refilled
+    void rebuild() {
+        for (vector<int>& list : postings) list.clear();
+        for (unsigned& v : versions) v++;
+        bankOfRow.assign(store.size(), -1);
+        for (int row = 0; row < store.size(); row++)
+            if (store.node[row]) insert(row);
+    }
+};
+BankIndex bankIndex;
+
+// Name index. Every distinct lowercased name gets a group of rows; groups are reached
+// through a radix trie (case-insensitive and prefix lookups, cost bounded by the
+// name length) and through a hash of the exact spelling (exact lookups).
+class NameIndex {
+    struct TrieNode {
+        size_t labelOffset;     // edge label, a slice of `labels`
+        int labelLength;
+        int firstChild = -1;    // children are kept sorted by their first label byte
+        int nextSibling = -1;
+        int group = -1;         // rows whose lowercased name ends exactly here
+    };
+    vector<TrieNode> trie{TrieNode{0, 0}};
+    string labels;                          // every distinct lowercased name, back to back
+    vector<vector<int>> groups;             // ascending rows per lowercased name
+    unordered_map<uint64_t, int> exact;     // hash of exact spelling -> group
+
+    static uint64_t hashName(string_view name) {
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : name) h = (h ^ c) * 1099511628211ULL;
+        return h;
+    }
+    static char lower(char c) { return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c; }
+    string_view label(const TrieNode& node) const { return string_view(labels.data() + node.labelOffset, node.labelLength); }
+
+    int childStartingWith(int node, char c) const {
+        for (int child = trie[node].firstChild; child != -1; child = trie[child].nextSibling)
+            if (labels[trie[child].labelOffset] == c) return child;
+        return -1;
+    }
+    void linkChild(int parent, int child) {
+        char c = labels[trie[child].labelOffset];
+        int* link = &trie[parent].firstChild;
+        while (*link != -1 && labels[trie[*link].labelOffset] < c) link = &trie[*link].nextSibling;
+        trie[child].nextSibling = *link;
+        *link = child;
+    }
+    // Walks `key`; returns the node where it ends, or -1. With allowPartial the key may
+    // stop inside an edge label, and the node below that edge is returned.
+    int walk(string_view key, bool allowPartial) const {
+        int node = 0;
+        size_t pos = 0;
+        while (pos < key.size()) {
+            int child = childStartingWith(node, key[pos]);
+            if (child == -1) return -1;
+            string_view edge = label(trie[child]);
+            size_t common = 0;
+            while (common < edge.size() && pos + common < key.size() && edge[common] == key[pos + common]) common++;
+            if (pos + common == key.size()) return (common == edge.size() || allowPartial) ? child : -1;
+            if (common < edge.size()) return -1;
+            node = child;
+            pos += common;
+        }
+        return node;
+    }
+    // Group for `key`, creating trie nodes and the group as needed
+    int groupFor(const string& key) {
+        int node = 0;
+        size_t pos = 0;
+        while (pos < key.size()) {
+            int child = childStartingWith(node, key[pos]);
+            if (child == -1) {
+                size_t offset = labels.size();
+                labels.append(key, pos, string::npos);
+                trie.push_back(TrieNode{offset, (int)(key.size() - pos)});
+                child = (int)trie.size() - 1;
+                linkChild(node, child);
+                node = child;
+                break;
+            }
+            string_view edge = label(trie[child]);
+            size_t common = 0;
+            while (common < edge.size() && pos + common < key.size() && edge[common] == key[pos + common]) common++;
+            if (common < edge.size()) {
+                // Split the edge: a new node takes the shared part and adopts `child`
+                TrieNode middle{trie[child].labelOffset, (int)common};
+                middle.nextSibling = trie[child].nextSibling;
+                middle.firstChild = child;
+                trie[child].labelOffset += common;
+                trie[child].labelLength -= (int)common;
+                trie[child].nextSibling = -1;
+                trie.push_back(middle);
+                int mid = (int)trie.size() - 1;
+                int* link = &trie[node].firstChild;
+                while (*link != child) link = &trie[*link].nextSibling;
+                *link = mid;
+                child = mid;
+            }
+            node = child;
+            pos += common;
+        }
+        if (trie[node].group == -1) {
+            trie[node].group = (int)groups.size();
+            groups.emplace_back();
+        }
+        return trie[node].group;
+    }
+    void collect(int node, size_t limit, vector<int>& out) const {
+        if (out.size() >= limit) return;
+        if (trie[node].group != -1)
+            for (int row : groups[trie[node].group]) {
+                if (out.size() >= limit) return;
+                out.push_back(row);
+            }
+        for (int child = trie[node].firstChild; child != -1; child = trie[child].nextSibling)
+            collect(child, limit, out);
+    }
+
+public:
+    static string toLower(string_view text) {
+        string key(text);
+        for (char& c : key) c = lower(c);
+        return key;
+    }
+
+    void insert(int row) {
+        string_view name = store.str(store.name[row]);
+        int group = groupFor(toLower(name));
+        exact.emplace(hashName(name), group);
+        vector<int>& rows = groups[group];
+        if (rows.empty() || rows.back() < row) rows.push_back(row);
+        else rows.insert(lower_bound(rows.begin(), rows.end(), row), row);
+    }
+    // Emptied groups keep their trie nodes until the next rebuild
+    void erase(int row) {
+        int node = walk(toLower(store.str(store.name[row])), false);
+        if (node == -1 || trie[node].group == -1) return;
+        vector<int>& rows = groups[trie[node].group];
+        auto it = lower_bound(rows.begin(), rows.end(), row);
+        if (it != rows.end() && *it == row) rows.erase(it);
+    }
+    // Hash map nodes are estimated at a key, a value and two pointers each
+    size_t bytesUsed() const {
+        size_t total = trie.capacity() * sizeof(TrieNode) + labels.capacity()
+                     + exact.size() * (sizeof(uint64_t) + sizeof(int) + 2 * sizeof(void*)) + exact.bucket_count() * sizeof(void*);
+        for (const vector<int>& rows : groups) total += sizeof(vector<int>) + rows.capacity() * sizeof(int);
+        return total;
+    }
+    void rebuild() {
+        trie.assign(1, TrieNode{0, 0});
+        labels.clear();
+        groups.clear();
+        exact.clear();
+        for (int row = 0; row < store.size(); row++)
+            if (store.node[row]) insert(row);
+    }
+
+    // The hash is only a shortcut: on a collision it names another name's group, which
+    // filters down to nothing, so an empty result is always confirmed through the trie
+    vector<int> findExact(string_view name) const {
+        vector<int> rows;
+        auto filter = [&](int group) {
+            for (int row : groups[group])
+                if (store.str(store.name[row]) == name) rows.push_back(row);
+        };
+        auto it = exact.find(hashName(name));
+        int hashed = it != exact.end() ? it->second : -1;
+        if (hashed != -1) filter(hashed);
+        if (rows.empty()) {
+            int node = walk(toLower(name), false);
+            if (node != -1 && trie[node].group != -1 && trie[node].group != hashed) filter(trie[node].group);
+        }
+        return rows;
+    }
+    vector<int> findIgnoreCase(string_view name) const {
+        int node = walk(toLower(name), false);
+        if (node == -1 || trie[node].group == -1) return vector<int>();
+        return groups[trie[node].group];
+    }
+    // Rows whose name starts with `prefix` (ignoring case), in alphabetical name order
+    vector<int> findPrefix(string_view prefix, size_t limit) const {
+        vector<int> rows;
+        int node = walk(toLower(prefix), true);
+        if (node != -1) collect(node, limit, rows);
+        return rows;
+    }
+};
+NameIndex nameIndex;
+
+// Live rows of one bank, in row (insertion) order
+vector<int> getNodesByBank(const string& bank) {
+    int id = bankIndex.find(bank);
+    return id == -1 ? vector<int>() : bankIndex.rows(id);
+}
+
+// "MM/YYYY" (or "MM/YY") as year * 12 + month; -1 when malformed
+int parseExpiryMonths(string_view expiry) {
+    size_t slash = expiry.find('/');
+    int month, year;
+    if (slash == string_view::npos
+        || from_chars(expiry.data(), expiry.data() + slash, month).ptr != expiry.data() + slash
+        || from_chars(expiry.data() + slash + 1, expiry.data() + expiry.size(), year).ptr != expiry.data() + expiry.size())
+        return -1;
+    if (year < 100) year += 2000;
+    return year * 12 + month;
+}
+// Bank graph in compressed sparse row form: the neighbours of vertex i (an index into
+// the bank's rows) are targets[offsets[i] .. offsets[i + 1]). The cards of a bank form
+// a ring in row order. Neighbour order follows the original adjacency-list version:
+// previous card first, except at the two ends of the row order where the wrap-around
+// edge made the next card come first.
+struct CSRGraph {
+    vector<int> offsets{0};
+    vector<int> targets;
+    int size() const { return (int)offsets.size() - 1; }
+    const int* begin(int u) const { return targets.data() + offsets[u]; }
+    const int* end(int u) const { return targets.data() + offsets[u + 1]; }
+};
+
+CSRGraph buildBankGraph(int n) {
+    CSRGraph graph;
+    graph.offsets.reserve(n + 1);
+    graph.targets.reserve(2 * (size_t)n);
+    for (int i = 0; i < n; i++) {
+        int first = (i - 1 + n) % n, second = (i + 1) % n;
+        if (i == 0 || i == n - 1) swap(first, second);
+        if (first != i) graph.targets.push_back(first);
+        if (second != i && second != first) graph.targets.push_back(second);
+        graph.offsets.push_back(graph.targets.size());
+    }
+    return graph;
+}
+
+// One CSR graph per bank, rebuilt only when the bank's version has moved on
+class BankGraphCache {
+    vector<CSRGraph> graphs;
+    vector<unsigned> versions;
+    vector<bool> built;
+
+public:
+    const CSRGraph& graph(int bank) {
+        if ((int)graphs.size() <= bank) {
+            graphs.resize(bank + 1);
+            versions.resize(bank + 1);
+            built.resize(bank + 1, false);
+        }
+        if (!built[bank] || versions[bank] != bankIndex.version(bank)) {
+            graphs[bank] = buildBankGraph(bankIndex.rows(bank).size());
+            versions[bank] = bankIndex.version(bank);
+            built[bank] = true;
+        }
+        return graphs[bank];
+    }
+    size_t bytesUsed() const {
+        size_t total = 0;
+        for (const CSRGraph& graph : graphs) total += (graph.offsets.capacity() + graph.targets.capacity()) * sizeof(int);
+        return total;
+    }
+};
+BankGraphCache bankGraphs;
+
+// BFS/DFS over a CSR graph. The frontier and visited stamps are kept between calls, so a
+// traversal allocates nothing once the buffers have grown; bumping `epoch` clears them.
+// visit(u) is called for each vertex in traversal order.
+class GraphTraversal {
+    vector<int> frontier;
+    vector<unsigned> seen;
+    unsigned epoch = 0;
+
+    void reset(int n) {
+        if ((int)seen.size() < n) seen.resize(n, 0);
+        if (++epoch == 0) {
+            fill(seen.begin(), seen.end(), 0);
+            epoch = 1;
+        }
+        frontier.clear();
+    }
+
+public:
+    template <typename F>
+    void bfs(const CSRGraph& graph, int start, F visit) {
+        if (start < 0 || start >= graph.size()) return;
+        reset(graph.size());
+        frontier.push_back(start);
+        seen[start] = epoch;
+        for (size_t head = 0; head < frontier.size(); head++) {
+            int u = frontier[head];
+            visit(u);
+            for (const int* v = graph.begin(u); v != graph.end(u); v++)
+                if (seen[*v] != epoch) {
+                    seen[*v] = epoch;
+                    frontier.push_back(*v);
+                }
+        }
+    }
+    // Neighbours are pushed in reverse so they pop in adjacency order
+    template <typename F>
+    void dfs(const CSRGraph& graph, int start, F visit) {
+        if (start < 0 || start >= graph.size()) return;
+        reset(graph.size());
+        frontier.push_back(start);
+        seen[start] = epoch;
+        while (!frontier.empty()) {
+            int u = frontier.back();
+            frontier.pop_back();
+            visit(u);
+            for (const int* v = graph.end(u); v != graph.begin(u);) {
+                --v;
+                if (seen[*v] != epoch) {
+                    seen[*v] = epoch;
+                    frontier.push_back(*v);
+                }
+            }
+        }
+    }
+};
+GraphTraversal traversal;
+
+// The traversal order is collected first so the timing leaves out the printing
+void printTraversal(const char* title, const vector<int>& order, const vector<int>& rows) {
+    cout << title << " Traversal:\n";
+    for (int u : order) cout << store.str(store.name[rows[u]]) << " (" << store.cardNo[rows[u]] << ") -> ";
+    cout << "END\n";
+}
+void printBFS(int bank) {
+    if (bank == -1 || bankIndex.rows(bank).empty()) return;
+    vector<int> order;
+    timed(OP_BFS, [&] { traversal.bfs(bankGraphs.graph(bank), 0, [&](int u) { order.push_back(u); }); });
+    printTraversal("BFS", order, bankIndex.rows(bank));
+}
+void printDFS(int bank) {
+    if (bank == -1 || bankIndex.rows(bank).empty()) return;
+    vector<int> order;
+    timed(OP_DFS, [&] { traversal.dfs(bankGraphs.graph(bank), 0, [&](int u) { order.push_back(u); }); });
+    printTraversal("DFS", order, bankIndex.rows(bank));
+}
+
+// Expiry-distance shortest path. Cards are points on one axis (expiry month) and every
+// pair in different months is joined by an edge of weight |difference|; same-month pairs
+// have no edge. On a line the direct edge is never beaten by a detour, so:
+//   different months: |a - b|
+//   same month:       out to the nearest other month and back, 2 * gap
+//   no other month:   unreachable (LLONG_MAX)
+// O(n) time and O(1) extra memory. Returns -1 if either card is not in `rows`; a card
+// listed twice resolves to its last occurrence, as in dijkstraPathDense.
+long long dijkstraPath(const vector<int>& rows, long long srcCard, long long destCard) {
+    int n = rows.size();
+    int srcIdx = -1, destIdx = -1;
+    for (int i = 0; i < n; i++) {
+        if (store.cardNo[rows[i]] == srcCard) srcIdx = i;
+        if (store.cardNo[rows[i]] == destCard) destIdx = i;
+    }
+    if (srcIdx == -1 || destIdx == -1) return -1;
+    if (srcIdx == destIdx) return 0;
+    long long a = store.expiryMonths[rows[srcIdx]], b = store.expiryMonths[rows[destIdx]];
+    if (a != b) return llabs(a - b);
+    long long gap = LLONG_MAX;
+    for (int row : rows) {
+        long long month = store.expiryMonths[row];
+        if (month != a) gap = min(gap, llabs(month - a));
+    }
+    return gap == LLONG_MAX ? LLONG_MAX : 2 * gap;
+}
+
+// Reference version: dense n x n matrix and array-scan Dijkstra, O(n^2) time and memory
+long long dijkstraPathDense(const vector<int>& rows, long long srcCard, long long destCard) {
+    int n = rows.size();
+    vector<vector<long long>> graph(n, vector<long long>(n, 0));
+    int srcIdx = -1, destIdx = -1;
+
+    for (int i = 0; i < n; i++) {
+        if (store.cardNo[rows[i]] == srcCard) srcIdx = i;
+        if (store.cardNo[rows[i]] == destCard) destIdx = i;
+        for (int j = 0; j < n; j++) {
+            if (i == j) continue;
+            int diff = abs(store.expiryMonths[rows[i]] - store.expiryMonths[rows[j]]);
+            graph[i][j] = diff;
+        }
+    }
+
+    if (srcIdx == -1 || destIdx == -1) return -1;
+
+    vector<long long> dist(n, LLONG_MAX);
+    vector<bool> visited(n, false);
+    dist[srcIdx] = 0;
+
+    for (int count = 0; count < n - 1; count++) {
+        long long minDist = LLONG_MAX;
+        int u = -1;
+        for (int i = 0; i < n; i++) {
+            if (!visited[i] && dist[i] < minDist) {
+                minDist = dist[i];
+                u = i;
+            }
+        }
+        if (u == -1) break;
+        visited[u] = true;
+        for (int v = 0; v < n; v++) {
+            if (!visited[v] && graph[u][v] && dist[u] != LLONG_MAX && dist[u] + graph[u][v] < dist[v]) {
+                dist[v] = dist[u] + graph[u][v];
+            }
+        }
+    }
+    return dist[destIdx];
+}
+
+// Billing-day MST. Every pair of cards is joined by an edge of weight |day difference|.
+// Cards are points on a line, so an MST joins each day's cards at weight 0 and then
+// consecutive distinct days, whose gaps add up to the latest day minus the earliest.
+// O(n) time and O(1) extra memory; the dense versions below run the actual algorithms.
+template <typename F>
+long long daySpan(int n, F dayOf) {
+    if (n == 0) return 0;
+    int lo = INT_MAX, hi = INT_MIN;
+    for (int i = 0; i < n; i++) {
+        lo = min(lo, dayOf(i));
+        hi = max(hi, dayOf(i));
+    }
+    return (long long)hi - lo;
+}
+
+long long primMST(const vector<int>& rows) {
+    return daySpan(rows.size(), [&](int i) { return store.billingDate[rows[i]]; });
+}
+
+// Reference version: dense n x n matrix, O(n^2) time and memory
+long long primMSTDense(const vector<int>& rows) {
+    int n = rows.size();
+    if (n == 0) return 0;
+
+    vector<vector<long long>> graph(n, vector<long long>(n, 0));
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (i == j) continue;
+            graph[i][j] = abs(store.billingDate[rows[i]] - store.billingDate[rows[j]]);
+        }
+    }
+
+    vector<long long> key(n, LLONG_MAX);
     vector<bool> inMST(n, false);
     key[0] = 0;
     long long totalWeight = 0;
@@ -610,14 +1700,19 @@ public:
     }
 };
 
-// Kruskal's MST implementation
-long long kruskalMST(const vector<Node*>& nodes) {
-    int n = nodes.size();
+// Same weight as primMST: any MST of the day line spans the latest day minus the earliest
+long long kruskalMST(const vector<int>& rows) {
+    return daySpan(rows.size(), [&](int i) { return store.billingDate[rows[i]]; });
+}
+
+// Reference version: all n(n-1)/2 edges materialized and sorted
+long long kruskalMSTDense(const vector<int>& rows) {
+    int n = rows.size();
     if (n <= 1) return 0;
     vector<tuple<int, int, int>> edges;
     for (int i = 0; i < n; i++) {
         for (int j = i + 1; j < n; j++) {
-            int weight = abs(nodes[i]->billingDate - nodes[j]->billingDate);
+            int weight = abs(store.billingDate[rows[i]] - store.billingDate[rows[j]]);
             edges.push_back({weight, i, j});
         }
     }
@@ -638,47 +1733,363 @@ long long kruskalMST(const vector<Node*>& nodes) {
     
     return totalWeight;
 }
+//Write-ahead log: every add and remove made through the menu is appended to "<file>.wal"
+//so it survives a restart. Records are
+//    [u32 payload length][u32 checksum of payload][u8 type][payload]
+//An ADD payload is the record's fields; a REMOVE payload is the row ID, which is stable
+//because rows are never reused and replay appends them in the same order.
+//Group commit: records collect in memory and sync() writes them with one write and one
+//fsync, so a burst of changes costs one disk flush. The buffer also flushes by itself
+//once it passes GROUP_BYTES.
+enum LogRecordType : uint8_t { LOG_ADD = 1, LOG_REMOVE = 2 };
+const char LOG_MAGIC[8] = {'C', 'X', 'W', 'A', 'L', '\0', '\0', '\0'};
+const uint32_t LOG_VERSION = 2;
+
+struct LogHeader {
+    char magic[8];
+    uint32_t version, endian;
+    uint64_t base;      // ID of the snapshot the log applies to; 0 means the parsed CSV
+    uint64_t sourceSize;    // size and modification time of the CSV under the log; row
+    int64_t sourceTime;     // IDs only mean the same rows while these are unchanged
+};
+
+uint32_t logChecksum(const char* data, size_t size) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; i++) h = (h ^ (unsigned char)data[i]) * 16777619u;
+    return h;
+}
+
+class WriteAheadLog {
+    FILE* file = nullptr;
+    vector<char> pending;
+    uint64_t records = 0;       // records in the file or pending, since the header
+    bool paused = false;
+
+    template <typename T>
+    void put(vector<char>& out, T value) {
+        const char* p = (const char*)&value;
+        out.insert(out.end(), p, p + sizeof(T));
+    }
+    void putString(vector<char>& out, string_view text) {
+        uint16_t length = min<size_t>(text.size(), 0xFFFF);
+        put(out, length);
+        out.insert(out.end(), text.begin(), text.begin() + length);
+    }
+    void append(LogRecordType type, const vector<char>& payload) {
+        if (!recording()) return;
+        vector<char> body;
+        body.reserve(payload.size() + 1);
+        body.push_back((char)type);
+        body.insert(body.end(), payload.begin(), payload.end());
+        put(pending, (uint32_t)body.size());
+        put(pending, logChecksum(body.data(), body.size()));
+        pending.insert(pending.end(), body.begin(), body.end());
+        records++;
+        if (pending.size() >= GROUP_BYTES) sync();
+    }
+
+public:
+    static constexpr size_t GROUP_BYTES = 1 << 16;
+    uint64_t base = 0;
+
+    ~WriteAheadLog() { close(); }
+    bool isOpen() const { return file != nullptr; }
+    bool recording() const { return file && !paused; }
+    uint64_t recordCount() const { return records; }
+    // Replay must not log what it re-applies
+    void pause(bool on) { paused = on; }
+
+    // Appends to `path`, which must already hold `existing` valid records
+    bool openForAppend(const string& path, uint64_t baseId, uint64_t existing) {
+        close();
+        file = fopen(path.c_str(), "ab");
+        base = baseId;
+        records = existing;
+        return file != nullptr;
+    }
+    void close() {
+        if (!file) return;
+        sync();
+        fclose(file);
+        file = nullptr;
+    }
+
+    void logAdd(int row) {
+        if (!recording()) return;
+        vector<char> payload;
+        put(payload, store.cardNo[row]);
+        put(payload, store.billingDate[row]);
+        put(payload, store.pin[row]);
+        put(payload, store.creditLimit[row]);
+        putString(payload, store.str(store.name[row]));
+        putString(payload, store.str(store.bank[row]));
+        putString(payload, store.str(store.expiryDate[row]));
+        append(LOG_ADD, payload);
+    }
+    void logRemove(int row) {
+        if (!recording()) return;
+        vector<char> payload;
+        put(payload, row);
+        append(LOG_REMOVE, payload);
+    }
+
+    // Writes every pending record and waits for the disk
+    bool sync() {
+        if (!file || pending.empty()) return true;
+        bool ok = fwrite(pending.data(), 1, pending.size(), file) == pending.size() && fflush(file) == 0;
+#ifdef _WIN32
+        ok = ok && _commit(_fileno(file)) == 0;
+#else
+        ok = ok && fsync(fileno(file)) == 0;
+#endif
+        pending.clear();
+        if (!ok) cerr << "Write-ahead log: write failed, recent changes may not be durable\n";
+        return ok;
+    }
+};
+WriteAheadLog wal;
+
+//Column scans: the PIN and card-number columns are contiguous, so an equality scan
+//compares 8 PINs or 4 cards per AVX2 instruction (4 and 2 with SSE2) instead of
+//chasing list nodes. The widest kernels the CPU supports are picked once at startup,
+//with a scalar fallback elsewhere. A kernel writes the offsets of matching values to
+//`out` (room for n) and returns how many there were; removed rows are filtered after.
+const int MAX_SCAN_KEYS = 8;   // PIN kernels compare against up to this many keys at once
+
+int scanPinsScalar(const int* values, int n, const int* keys, int keyCount, int* out) {
+    int found = 0;
+    for (int i = 0; i < n; i++) {
+        bool match = false;
+        for (int k = 0; k < keyCount; k++) match |= values[i] == keys[k];
+        out[found] = i;
+        found += match;
+    }
+    return found;
+}
+int scanCardsScalar(const long long* values, int n, long long key, int* out) {
+    int found = 0;
+    for (int i = 0; i < n; i++) {
+        out[found] = i;
+        found += values[i] == key;
+    }
+    return found;
+}
+#ifdef SCAN_X86
+// Appends i + (index of each set bit of mask)
+inline int emitMatches(unsigned mask, int i, int* out, int found) {
+    while (mask) {
+        out[found++] = i + __builtin_ctz(mask);
+        mask &= mask - 1;
+    }
+    return found;
+}
+__attribute__((target("avx2")))
+int scanPinsAVX2(const int* values, int n, const int* keys, int keyCount, int* out) {
+    __m256i wanted[MAX_SCAN_KEYS];
+    for (int k = 0; k < keyCount; k++) wanted[k] = _mm256_set1_epi32(keys[k]);
+    int found = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(values + i));
+        __m256i hit = _mm256_cmpeq_epi32(v, wanted[0]);
+        for (int k = 1; k < keyCount; k++) hit = _mm256_or_si256(hit, _mm256_cmpeq_epi32(v, wanted[k]));
+        found = emitMatches(_mm256_movemask_ps(_mm256_castsi256_ps(hit)), i, out, found);
+    }
+    for (int tail = scanPinsScalar(values + i, n - i, keys, keyCount, out + found), t = 0; t < tail; t++) out[found++] += i;
+    return found;
+}
+__attribute__((target("avx2")))
+int scanCardsAVX2(const long long* values, int n, long long key, int* out) {
+    __m256i wanted = _mm256_set1_epi64x(key);
+    int found = 0, i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i hit = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)(values + i)), wanted);
+        found = emitMatches(_mm256_movemask_pd(_mm256_castsi256_pd(hit)), i, out, found);
+    }
+    for (int tail = scanCardsScalar(values + i, n - i, key, out + found), t = 0; t < tail; t++) out[found++] += i;
+    return found;
+}
+__attribute__((target("sse2")))
+int scanPinsSSE2(const int* values, int n, const int* keys, int keyCount, int* out) {
+    __m128i wanted[MAX_SCAN_KEYS];
+    for (int k = 0; k < keyCount; k++) wanted[k] = _mm_set1_epi32(keys[k]);
+    int found = 0, i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(values + i));
+        __m128i hit = _mm_cmpeq_epi32(v, wanted[0]);
+        for (int k = 1; k < keyCount; k++) hit = _mm_or_si128(hit, _mm_cmpeq_epi32(v, wanted[k]));
+        found = emitMatches(_mm_movemask_ps(_mm_castsi128_ps(hit)), i, out, found);
+    }
+    for (int tail = scanPinsScalar(values + i, n - i, keys, keyCount, out + found), t = 0; t < tail; t++) out[found++] += i;
+    return found;
+}
+// SSE2 has no 64-bit compare: both 32-bit halves must match
+__attribute__((target("sse2")))
+int scanCardsSSE2(const long long* values, int n, long long key, int* out) {
+    __m128i wanted = _mm_set1_epi64x(key);
+    int found = 0, i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i halves = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(values + i)), wanted);
+        __m128i hit = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+        found = emitMatches(_mm_movemask_pd(_mm_castsi128_pd(hit)), i, out, found);
+    }
+    for (int tail = scanCardsScalar(values + i, n - i, key, out + found), t = 0; t < tail; t++) out[found++] += i;
+    return found;
+}
+#endif
+
+struct ScanKernels {
+    const char* name;
+    int (*pins)(const int* values, int n, const int* keys, int keyCount, int* out);
+    int (*cards)(const long long* values, int n, long long key, int* out);
+};
+const ScanKernels SCALAR_SCAN{"scalar", scanPinsScalar, scanCardsScalar};
+#ifdef SCAN_X86
+const ScanKernels SSE2_SCAN{"sse2", scanPinsSSE2, scanCardsSSE2};
+const ScanKernels AVX2_SCAN{"avx2", scanPinsAVX2, scanCardsAVX2};
+#endif
+// Every kernel set this CPU can run, widest first
+vector<ScanKernels> supportedScanKernels() {
+    vector<ScanKernels> kernels;
+#ifdef SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) kernels.push_back(AVX2_SCAN);
+    if (__builtin_cpu_supports("sse2")) kernels.push_back(SSE2_SCAN);
+#endif
+    kernels.push_back(SCALAR_SCAN);
+    return kernels;
+}
+ScanKernels scanKernels = supportedScanKernels().front();
+
+// Live rows whose PIN is any of `pins`, in row order, stopping after `limit`. Up to
+// MAX_SCAN_KEYS PINs go through the vector kernel; a longer list is checked against a
+// bitmap of the PINs (or a sorted copy if they are too spread out for one).
+vector<int> scanPins(const vector<int>& pins, size_t limit = SIZE_MAX) {
+    const int BLOCK = 4096;
+    vector<int> rows;
+    int n = store.size(), offsets[BLOCK];
+    if (pins.empty() || limit == 0) return rows;
+    vector<int> sorted(pins);
+    sort(sorted.begin(), sorted.end());
+    sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+    bool many = sorted.size() > (size_t)MAX_SCAN_KEYS;
+    long long lowest = sorted.front(), span = (long long)sorted.back() - lowest + 1;
+    vector<uint64_t> bitmap;
+    if (many && span <= (1 << 20)) {
+        bitmap.assign((span + 63) / 64, 0);
+        for (int pin : sorted) bitmap[(pin - lowest) >> 6] |= 1ULL << ((pin - lowest) & 63);
+    }
+    auto wanted = [&](int pin) {
+        if (bitmap.empty()) return binary_search(sorted.begin(), sorted.end(), pin);
+        long long at = (long long)pin - lowest;
+        return at >= 0 && at < span && (bitmap[at >> 6] >> (at & 63) & 1);
+    };
+    for (int base = 0; base < n; base += BLOCK) {
+        int width = min(BLOCK, n - base), found = 0;
+        if (!many) found = scanKernels.pins(store.pin.data() + base, width, sorted.data(), sorted.size(), offsets);
+        else
+            for (int i = 0; i < width; i++) {
+                offsets[found] = i;
+                found += wanted(store.pin[base + i]);
+            }
+        for (int i = 0; i < found; i++)
+            if (store.node[base + offsets[i]]) {
+                rows.push_back(base + offsets[i]);
+                if (rows.size() == limit) return rows;
+            }
+    }
+    return rows;
+}
+// Live rows holding the card, in row order, stopping after `limit`
+vector<int> scanCards(long long cardNo, size_t limit = SIZE_MAX) {
+    const int BLOCK = 4096;
+    vector<int> rows;
+    int n = store.size(), offsets[BLOCK];
+    for (int base = 0; base < n && rows.size() < limit; base += BLOCK) {
+        int found = scanKernels.cards(store.cardNo.data() + base, min(BLOCK, n - base), cardNo, offsets);
+        for (int i = 0; i < found && rows.size() < limit; i++)
+            if (store.node[base + offsets[i]]) rows.push_back(base + offsets[i]);
+    }
+    return rows;
+}
+
+//Bulk loading: records are appended without touching any index, and
+//endBulkLoad() builds every index once over the whole list
+bool bulkLoading = false;
+
+void buildIndexes() {
+    bstPool.reset();
+    bstRoot = buildBST();
+    avlPool.reset();
+    avlRoot = buildAVL();
+    expiryRoot = buildAVL(expiryKey);
+    cardIndex.invalidate();
+    cardHeap.build();
+    creditHeap.build();
+    rebuildHashTables();
+    pinView.invalidate();
+    bankIndex.rebuild();
+    nameIndex.rebuild();
+}
+void beginBulkLoad() { bulkLoading = true; }
+void endBulkLoad() {
+    bulkLoading = false;
+    buildIndexes();
+}
 //operations on data
-void addNode(string name, string bank, string expiryDate, long long cardNo, int billingDate, int pin) {
-    Node* node= new Node;
-    node->name = name;
-    node->bank = bank;
-    node->expiryDate = expiryDate;
-    node->cardNo = cardNo;
-    node->billingDate = billingDate;
-    node->pin = pin;
+Node* newNode(int row, Pool<Node>& pool = nodePool) {
+    Node* node = pool.create();
+    node->row = row;
     node->prev = nullptr;
     node->next = nullptr;
-    if (!head) {head = tail = node; return;}
-    node->prev = tail;
-    tail->next = node;
-    tail = node;
-    History::stack.push(node);
-    rebuildHashTables();
+    return node;
+}
+void addNode(string_view name, string_view bank, string_view expiryDate, long long cardNo, int billingDate, int pin, int creditLimit = 0) {
+    auto start = chrono::steady_clock::now();
+    int row = store.append(name, bank, expiryDate, cardNo, billingDate, pin, creditLimit);
+    Node* node = newNode(row);
+    store.node[row] = node;
+    store.liveRows++;
+    if (!head) head = tail = node;
+    else {
+        node->prev = tail;
+        tail->next = node;
+        tail = node;
+        History::stack.push(row);
+    }
+    if (bulkLoading) return;
+    pinIndex.insert(row);
+    pinView.add(row);
+    bankIndex.insert(row);
+    nameIndex.insert(row);
+    bstRoot = insertBST(bstRoot, row);
+    avlRoot = insertAVL(avlRoot, row, cardKey(row));
+    expiryRoot = insertAVL(expiryRoot, row, expiryKey(row));
+    cardIndex.invalidate();
+    cardHeap.insert(row);
+    creditHeap.insert(row);
+    wal.logAdd(row);
+    latencies[OP_INSERT].record(nanosSince(start));
 }
+// Records stay put in the store; swapping two list positions only swaps their rows
 void swapNodeData(Node* a, Node* b) {
-    swap(a->name, b->name);
-    swap(a->bank, b->bank);
-    swap(a->expiryDate, b->expiryDate);
-    swap(a->cardNo, b->cardNo);
-    swap(a->pin, b->pin);
-    swap(a->billingDate, b->billingDate);
-}
-int linearSearch(Node* head, int key) {
-    int idx = 0;
-    for(Node* p = head; p; p = p->next, ++idx)
-        if(p->pin == key) return idx;
-    return -1;
+    swap(a->row, b->row);
+    store.node[a->row] = a;
+    store.node[b->row] = b;
+}
+// First live row with the PIN, or -1
+int linearSearch(int key) {
+    vector<int> rows = scanPins({key}, 1);
+    return rows.empty() ? -1 : rows[0];
 }
-int binarySearch(Array& A, int key){
-    int lo=0, hi=A.length-1;
-    while(lo<=hi){
+// Position of the first row with the PIN in `sorted` (rows ordered by PIN), or -1
+int binarySearch(const vector<int>& sorted, int key){
+    int lo=0, hi=sorted.size();
+    while(lo<hi){
         int mid = lo + (hi-lo)/2;
-        if(A.nodes[mid]->pin == key) return mid;
-        if(A.nodes[mid]->pin < key) lo = mid+1;
-        else hi = mid-1;
+        if(store.pin[sorted[mid]] < key) lo = mid+1;
+        else hi = mid;
     }
-    return -1;
+    return (lo < (int)sorted.size() && store.pin[sorted[lo]] == key) ? lo : -1;
 }
 void bubbleSortList(Node* head) {
     if(!head) return;
@@ -686,8 +2097,8 @@ void bubbleSortList(Node* head) {
     do {
         swapped = false;
         for(Node* p = head; p->next; p = p->next) {
-            if(p->pin > p->next->pin) {
-                swapNodeData(p, p->next); // swap all data
+            if(p->pin() > p->next->pin()) {
+                swapNodeData(p, p->next);
                 swapped = true;
             }
         }
@@ -697,8 +2108,8 @@ void selectionSortList(Node* head) {
     for(Node* i = head; i; i = i->next) {
         Node* minN = i;
         for(Node* j = i->next; j; j = j->next)
-            if(j->pin < minN->pin) minN = j;
-        swapNodeData(i, minN);  // Swap all data
+            if(j->pin() < minN->pin()) minN = j;
+        swapNodeData(i, minN);
     }
 }
 Node* insertionSortList(Node* head){
@@ -706,11 +2117,11 @@ Node* insertionSortList(Node* head){
     while(head){
         Node* cur = head; head = head->next;
         cur->next = nullptr;
-        if(!sorted || cur->pin < sorted->pin){
+        if(!sorted || cur->pin() < sorted->pin()){
             cur->next = sorted; sorted = cur;
         } else {
             Node* p = sorted;
-            while(p->next && p->next->pin < cur->pin)
+            while(p->next && p->next->pin() < cur->pin())
                 p = p->next;
             cur->next = p->next; p->next = cur;
         }
@@ -720,7 +2131,7 @@ Node* insertionSortList(Node* head){
 Node* mergeLists(Node* a, Node* b){
     Node dummy; Node* t = &dummy; dummy.next = nullptr;
     while(a && b){
-        if(a->pin <= b->pin){
+        if(a->pin() <= b->pin()){
             t->next = a; a = a->next;
         } else {
             t->next = b; b = b->next;
@@ -741,68 +2152,187 @@ Node* mergeSortList(Node* head){
     Node* mid = slow->next; slow->next = nullptr;
     return mergeLists(mergeSortList(head), mergeSortList(mid));
 }
+// insertionSortList and mergeSortList only relink `next`; this restores `prev` and `tail`
+void restoreBackLinks() {
+    Node* prev = nullptr;
+    for (Node* p = head; p; p = p->next) {
+        p->prev = prev;
+        prev = p;
+    }
+    tail = prev;
+}
+// Live rows in list order
+vector<int> listRows() {
+    vector<int> rows;
+    rows.reserve(store.liveRows);
+    for (Node* p = head; p; p = p->next) rows.push_back(p->row);
+    return rows;
+}
+// Relinks the list nodes in the order of `rows` (every live row, once); records stay put
+void relinkList(const vector<int>& rows) {
+    Node* prev = nullptr;
+    head = nullptr;
+    for (int row : rows) {
+        Node* node = store.node[row];
+        node->prev = prev;
+        if (prev) prev->next = node;
+        else head = node;
+        prev = node;
+    }
+    if (prev) prev->next = nullptr;
+    tail = prev;
+}
+
+// Sort engine: orders (key, row) pairs and returns the live rows as a permutation, so no
+// record is moved. Keys are shifted to start at 0. A key range no wider than the row
+// count (or 64K) takes one counting pass, as PINs, billing days and expiry months do.
+// Wider keys such as card numbers take an LSD radix sort on 8-bit digits. All digit
+// histograms come from one pass, and a digit every key shares is skipped. Both are
+// stable, so equal keys keep row order.
+vector<int> sortedRows(long long (*keyOf)(int row)) {
+    vector<int> rows;
+    rows.reserve(store.liveRows);
+    for (int row = 0; row < store.size(); row++)
+        if (store.node[row]) rows.push_back(row);
+    int n = rows.size();
+    if (n < 2) return rows;
+    vector<uint64_t> keys(n);
+    long long lowest = LLONG_MAX, highest = LLONG_MIN;
+    for (int i = 0; i < n; i++) {
+        long long key = keyOf(rows[i]);
+        keys[i] = key;
+        lowest = min(lowest, key);
+        highest = max(highest, key);
+    }
+    uint64_t range = (uint64_t)highest - (uint64_t)lowest;
+    for (uint64_t& key : keys) key -= (uint64_t)lowest;
+    vector<int> sorted(n);
+    if (range < max<uint64_t>(1 << 16, n)) {
+        vector<int> start(range + 2, 0);
+        for (uint64_t key : keys) start[key + 1]++;
+        for (uint64_t k = 1; k <= range + 1; k++) start[k] += start[k - 1];
+        for (int i = 0; i < n; i++) sorted[start[keys[i]]++] = rows[i];
+        return sorted;
+    }
+    int digits = 0;
+    while (digits < 8 && (range >> (8 * digits))) digits++;
+    vector<uint64_t> sortedKeys(n);
+    vector<array<int, 256>> counts(digits);
+    for (auto& count : counts) count.fill(0);
+    for (uint64_t key : keys)
+        for (int d = 0; d < digits; d++) counts[d][(key >> (8 * d)) & 0xFF]++;
+    for (int d = 0; d < digits; d++) {
+        int shift = 8 * d, start[256], total = 0;
+        if (*max_element(counts[d].begin(), counts[d].end()) == n) continue;
+        for (int b = 0; b < 256; b++) {
+            start[b] = total;
+            total += counts[d][b];
+        }
+        for (int i = 0; i < n; i++) {
+            int at = start[(keys[i] >> shift) & 0xFF]++;
+            sortedKeys[at] = keys[i];
+            sorted[at] = rows[i];
+        }
+        keys.swap(sortedKeys);
+        rows.swap(sorted);
+    }
+    return rows;
+}
 void print() {
     if (!head) return;
     Node *node = head;
     while (node) {
-        cout<<"Card Holder Name: "<<node->name<<", Issuing Bank: "<<node->bank<<", Card Number: "<<node->cardNo<<", Card Expiry Date: "<<node->expiryDate<<", Card PIN: "<<node->pin;
+        cout<<"Card Holder Name: "<<node->name()<<", Issuing Bank: "<<node->bank()<<", Card Number: "<<node->cardNo()<<", Card Expiry Date: "<<node->expiryDate()<<", Card PIN: "<<node->pin();
         cout<<"\n";
         node=node->next;
     }
 }
+const size_t NAME_MATCH_LIMIT = 50;
+// Exact name first; failing that, the same name in any case; failing that, up to
+// NAME_MATCH_LIMIT names starting with it (byPrefix is set)
+vector<int> findUsers(string_view user, bool& byPrefix) {
+    byPrefix = false;
+    vector<int> rows = nameIndex.findExact(user);
+    if (rows.empty()) rows = nameIndex.findIgnoreCase(user);
+    if (rows.empty()) {
+        rows = nameIndex.findPrefix(user, NAME_MATCH_LIMIT);
+        byPrefix = !rows.empty();
+    }
+    return rows;
+}
 void print(string user) {
-    if (!head) return;
-    Node *node = head;
-    while (node) {
-        if (node->name == user) cout<<"Card Holder Name: "<<node->name<<", Issuing Bank: "<<node->bank<<", Card Number: "<<node->cardNo<<", Card Expiry Date: "<<node->expiryDate;
-        node=node->next;
+    bool byPrefix;
+    vector<int> rows = timed(OP_SEARCH_NAME, [&] { return findUsers(user, byPrefix); });
+    if (byPrefix) cout<<"No exact match; names starting with \""<<user<<"\":\n";
+    for (int row : rows) {
+        Node* node = store.node[row];
+        cout<<"Card Holder Name: "<<node->name()<<", Issuing Bank: "<<node->bank()<<", Card Number: "<<node->cardNo()<<", Card Expiry Date: "<<node->expiryDate()<<"\n";
+    }
+    if (rows.size() == NAME_MATCH_LIMIT) cout<<"(showing the first "<<NAME_MATCH_LIMIT<<" matches)\n";
+    if (rows.empty()) cout<<"No user named \""<<user<<"\"\n";
+}
+void removeRow(int row) {
+    ScopedTimer timer(OP_REMOVE);
+    wal.logRemove(row);
+    Node* node = store.node[row];
+    if (node->prev) node->prev->next = node->next;
+    else head = node->next;
+    if (node->next) node->next->prev = node->prev;
+    else tail = node->prev;
+    pinIndex.erase(row);
+    pinView.remove();
+    bankIndex.erase(row);
+    nameIndex.erase(row);
+    cardHeap.erase(row);
+    creditHeap.erase(row);
+    store.node[row] = nullptr;
+    store.liveRows--;
+    nodePool.destroy(node);
+    // The BST keeps one row per card: hand its node to another live copy if there is one
+    long long cardNo = store.cardNo[row];
+    avlRoot = removeAVL(avlRoot, row, cardKey(row));
+    expiryRoot = removeAVL(expiryRoot, row, expiryKey(row));
+    cardIndex.invalidate();
+    if (searchBST(bstRoot, cardNo) == row) {
+        int other = searchAVL(avlRoot, cardNo);
+        if (other != -1) {
+            BST* p = bstRoot;
+            while (p->cardNo != cardNo) p = cardNo < p->cardNo ? p->left : p->right;
+            p->row = other;
+        } else bstRoot = removeBST(bstRoot, cardNo);
     }
 }
+// Lowest live row with both the card number and the PIN, or -1; only the PIN's group is scanned
+int findCardWithPin(long long cardNo, int pin) {
+    const int* rows;
+    int count = pinIndex.findAll(pin, &rows);
+    int found = -1;
+    for (int i = 0; i < count; i++)
+        if (store.cardNo[rows[i]] == cardNo && (found == -1 || rows[i] < found)) found = rows[i];
+    return found;
+}
 void removeUser(long long cardNo, int pin) {
-    if (!head) return;
-    Node* node = head;
-    while (node) {
-        if (node->cardNo==cardNo && node->pin == pin) {
-            if (head==tail) head = tail = nullptr;
-            else if (node==head) {
-                head=head->next;
-                delete(head->prev);
-                head->prev = nullptr;
-                cout<<"Deleted\n";
-                rebuildHashTables();
-                return;
-            }
-            else if (node==tail) {
-                tail = tail->prev;
-                delete(tail->next);
-                tail->next = nullptr;
-                cout<<"Deleted\n";
-                rebuildHashTables();
-                return;
-            }
-            else {
-                node->prev->next = node->next;
-                node->next->prev = node->prev;
-                delete node;
-                cout<<"Deleted\n";
-                rebuildHashTables();
-                return;
-            }
-        }
-        node = node->next;
+    int row = findCardWithPin(cardNo, pin);
+    if (row != -1) {
+        removeRow(row);
+        cout<<"Deleted\n";
+        return;
     }
     cout<<"Not Found";
 }
-Node* getLastUser() {
-    if (History::stack.isEmpty()) return nullptr;
-    return History::stack.pop();
+// Most recently added row that still exists, or -1; removed rows are skipped
+int getLastUser() {
+    while (!History::stack.isEmpty()) {
+        int row = History::stack.pop();
+        if (store.isLive(row)) return row;
+    }
+    return -1;
 }
 void removeLastUser() {
-    if (History::stack.isEmpty()) return;
-    Node* lastAdded = History::stack.peek();
-    removeUser(lastAdded->cardNo, lastAdded->pin);
+    int row = getLastUser();
+    if (row != -1) removeRow(row);
 }
-//Use queues to parse the csv
+//Use queues to parse the csv (the original parser, kept as the --bench-ingest baseline)
 Queue<string> splitLine(string& line) {
     Queue<string> row;
     int currentIndex = 0;
@@ -846,31 +2376,2070 @@ Queue<Queue<string>> parseFile(string fileLocation) {
     return rows;
 }
 
-void parseQueueToLinkedList(Queue<Queue<string>> rows) {
-    while (!rows.isEmpty()) {
-        Queue<string> row = rows.dequeue();
-        string bank = getAttribute(row, 2);
-        long long cardNo = stoll(getAttribute(row, 3));
-        string name = getAttribute(row, 4);
-        string expiryDate = getAttribute(row, 7);
-        int billingDate = stoi(getAttribute(row, 8));
-        int pin = stoi(getAttribute(row, 9));
-        addNode(name, bank, expiryDate, cardNo, billingDate, pin);
+//Memory-mapped ingest: fields are views into the mapping, nothing is copied per row
+const int CSV_COLUMNS = 11;
+
+struct MappedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+    bool opened = false;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+    MappedFile(const string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER length;
+        if (!GetFileSizeEx(file, &length)) return;
+        size = (size_t)length.QuadPart;
+        opened = true;
+        if (size == 0) return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) { opened = false; return; }
+        data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data) opened = false;
+#else
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) != 0) return;
+        size = (size_t)st.st_size;
+        opened = true;
+        if (size == 0) return;
+        void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) { opened = false; return; }
+        madvise(p, size, MADV_SEQUENTIAL);
+        data = (const char*)p;
+#endif
+    }
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (data) munmap((void*)data, size);
+        if (fd >= 0) close(fd);
+#endif
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    bool isOpen() const { return opened; }
+    const char* begin() const { return data; }
+    const char* end() const { return data + size; }
+};
+
+// Splits a line on commas; returns the number of fields written (at most maxFields)
+int splitLineView(string_view line, string_view* fields, int maxFields) {
+    int count = 0;
+    size_t currentIndex = 0;
+    while (count < maxFields) {
+        size_t nextCommaIndex = line.find(',', currentIndex);
+        if (nextCommaIndex == string_view::npos) {
+            fields[count++] = line.substr(currentIndex);
+            break;
+        }
+        fields[count++] = line.substr(currentIndex, nextCommaIndex - currentIndex);
+        currentIndex = nextCommaIndex + 1;
     }
+    return count;
 }
 
+template <typename T>
+bool parseNumber(string_view text, T& value) {
+    while (!text.empty() && text.front() == ' ') text.remove_prefix(1);
+    while (!text.empty() && text.back() == ' ') text.remove_suffix(1);
+    auto result = from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == errc() && result.ptr == text.data() + text.size();
+}
 
-//prompt user
-int main() {
-    string fileLocation = "bank.csv";
-    Queue<Queue<string>> rows = parseFile(fileLocation);
-    parseQueueToLinkedList(rows);
-    bstRoot = buildBST();
-    avlRoot = buildAVL();
-    heap = new Heap(head);
-    rebuildHashTables();
-    int choice = 0;
-    do {
+// One CSV row, still pointing into the mapped file
+struct RowView {
+    string_view bank, name, expiryDate;
+    long long cardNo;
+    int billingDate, pin, creditLimit;
+};
+
+bool parseRowView(const string_view* fields, int count, RowView& row) {
+    if (count < 10) return false;
+    row.bank = fields[2];
+    row.name = fields[4];
+    row.expiryDate = fields[7];
+    row.creditLimit = 0;    // optional column
+    return parseNumber(fields[3], row.cardNo)
+        && parseNumber(fields[8], row.billingDate)
+        && parseNumber(fields[9], row.pin)
+        && (count < 11 || fields[10].empty() || parseNumber(fields[10], row.creditLimit));
+}
+
+// Calls fn(row) for every well-formed line in [begin, end); returns how many lines were skipped
+template <typename F>
+int forEachRowView(const char* begin, const char* end, F fn) {
+    string_view fields[CSV_COLUMNS];
+    int skipped = 0;
+    const char* p = begin;
+    while (p < end) {
+        const char* eol = (const char*)memchr(p, '\n', end - p);
+        if (!eol) eol = end;
+        string_view line(p, eol - p);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        p = eol + 1;
+        if (line.empty()) continue;
+        RowView row;
+        if (parseRowView(fields, splitLineView(line, fields, CSV_COLUMNS), row)) fn(row);
+        else skipped++;
+    }
+    return skipped;
+}
+
+// Skips the header line of a mapped CSV
+const char* skipHeader(const MappedFile& file) {
+    if (!file.data) return nullptr;
+    const char* eol = (const char*)memchr(file.begin(), '\n', file.size);
+    return eol ? eol + 1 : file.end();
+}
+
+// Runs fn(0..tasks-1) on up to `threads` workers; tasks are handed out in order as workers free up
+template <typename F>
+void parallelFor(int tasks, int threads, F fn) {
+    threads = max(1, min(threads, tasks));
+    if (threads == 1) {
+        for (int i = 0; i < tasks; i++) fn(i);
+        return;
+    }
+    atomic<int> nextTask(0);
+    auto worker = [&]() {
+        for (int i = nextTask++; i < tasks; i = nextTask++) fn(i);
+    };
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker);
+    worker();
+    for (thread& t : pool) t.join();
+}
+
+int defaultThreadCount() {
+    unsigned n = thread::hardware_concurrency();
+    return n ? (int)n : 1;
+}
+
+// Cuts [begin, end) into about `parts` pieces, each ending just after a newline
+vector<const char*> splitAtNewlines(const char* begin, const char* end, int parts) {
+    vector<const char*> cuts{begin};
+    size_t step = (end - begin) / max(parts, 1) + 1;
+    while (end - cuts.back() > (ptrdiff_t)step) {
+        const char* eol = (const char*)memchr(cuts.back() + step, '\n', end - (cuts.back() + step));
+        if (!eol) break;
+        cuts.push_back(eol + 1);
+    }
+    cuts.push_back(end);
+    return cuts;
+}
+
+// A run of parsed records, linked but not yet attached to head/tail.
+// Rows are numbered from 0 inside the chunk until they are copied into `store`.
+struct ChunkList {
+    Node* first = nullptr;
+    Node* last = nullptr;
+    int skipped = 0;
+    int rowBase = 0;
+    size_t byteBase = 0;
+    RecordStore records;
+    Pool<Node> nodes;   // per-chunk, so workers never share an allocator
+};
+
+const size_t MIN_CHUNK_BYTES = 1 << 20;
+
+// Parses the file in newline-aligned chunks on a worker pool, then splices the chunks
+// onto the list in file order, so head/tail come out the same as a serial load.
+// Indexes are not touched; wrap the call in beginBulkLoad()/endBulkLoad().
+bool loadMappedFile(const string& fileLocation, int threads = defaultThreadCount()) {
+    ScopedTimer timer(OP_PARSE);
+    MappedFile file(fileLocation);
+    if (!file.isOpen()) {
+        cerr << "File cannot be opened: " << fileLocation << endl;
+        return false;
+    }
+    if (!file.data) return true;
+    const char* body = skipHeader(file);
+    size_t bytes = file.end() - body;
+    threads = max(1, min<int>(threads, bytes / MIN_CHUNK_BYTES));
+    vector<const char*> cuts = splitAtNewlines(body, file.end(), threads * 4);
+    vector<ChunkList> chunks(cuts.size() - 1);
+
+    parallelFor(chunks.size(), threads, [&](int i) {
+        ChunkList& chunk = chunks[i];
+        chunk.records.bytes.reserve(cuts[i + 1] - cuts[i]);
+        chunk.skipped = forEachRowView(cuts[i], cuts[i + 1], [&](const RowView& row) {
+            int local = chunk.records.append(row.name, row.bank, row.expiryDate, row.cardNo, row.billingDate, row.pin, row.creditLimit);
+            Node* node = newNode(local, chunk.nodes);
+            if (!chunk.first) chunk.first = node;
+            else {
+                node->prev = chunk.last;
+                chunk.last->next = node;
+            }
+            chunk.last = node;
+        });
+    });
+
+    // Give every chunk its slice of the store, then copy the columns over in parallel
+    int rows = store.size();
+    size_t byteCount = store.bytes.size();
+    for (ChunkList& chunk : chunks) {
+        chunk.rowBase = rows;
+        chunk.byteBase = byteCount;
+        rows += chunk.records.size();
+        byteCount += chunk.records.bytes.size();
+    }
+    store.resize(rows, byteCount);
+    parallelFor(chunks.size(), threads, [&](int i) {
+        ChunkList& chunk = chunks[i];
+        store.copyRows(chunk.records, chunk.rowBase, chunk.byteBase);
+        for (Node* p = chunk.first; p; p = p->next) {
+            p->row += chunk.rowBase;
+            store.node[p->row] = p;
+        }
+        chunk.records = RecordStore();
+    });
+
+    int skipped = 0;
+    for (ChunkList& chunk : chunks) {
+        skipped += chunk.skipped;
+        nodePool.adopt(chunk.nodes);
+        if (!chunk.first) continue;
+        if (!head) head = chunk.first;
+        else {
+            chunk.first->prev = tail;
+            tail->next = chunk.first;
+        }
+        tail = chunk.last;
+        // Same bookkeeping addNode does per record: only appends to a non-empty list go on History
+        for (Node* p = chunk.first; p; p = p->next)
+            if (p != head) History::stack.push(p->row);
+    }
+    store.liveRows = 0;
+    for (Node* p = head; p; p = p->next) store.liveRows++;
+    if (skipped) cerr << "Skipped " << skipped << " malformed rows in " << fileLocation << "\n";
+    return true;
+}
+
+//Multi-key sort: orders rows by a composite key such as (bank, expiry, card number),
+//keeping rows with equal keys in their input order. Each field is first turned into one
+//64-bit word per row that sorts the same way; strings become their rank among the
+//distinct values, so comparisons never touch the strings. Then the rows are cut into
+//one run per worker and each run is stable-sorted. Runs are merged pairwise, level by
+//level. Every merge is cut along its merge path into pieces of about n / workers
+//outputs, so even the last, largest merges keep every worker busy. Workers pull pieces
+//from a shared counter (parallelFor) as they free up.
+enum SortField { FIELD_NAME, FIELD_BANK, FIELD_CARD, FIELD_EXPIRY, FIELD_BILLING, FIELD_PIN, FIELD_CREDIT };
+struct SortKey {
+    SortField field;
+    bool descending;
+};
+const pair<const char*, SortField> SORT_FIELD_NAMES[] = {
+    {"name", FIELD_NAME}, {"bank", FIELD_BANK}, {"card", FIELD_CARD}, {"expiry", FIELD_EXPIRY},
+    {"billing", FIELD_BILLING}, {"pin", FIELD_PIN}, {"credit", FIELD_CREDIT}};
+
+string_view trimmed(string_view text);
+
+// Reads "bank,expiry,card" (most significant first; "-credit" sorts that field
+// descending). Returns false on an unknown or missing field.
+bool parseSortSpec(string_view text, vector<SortKey>& spec) {
+    spec.clear();
+    while (true) {
+        size_t comma = text.find(',');
+        string_view field = trimmed(text.substr(0, comma));
+        bool descending = !field.empty() && field[0] == '-';
+        if (descending) field.remove_prefix(1);
+        auto known = find_if(begin(SORT_FIELD_NAMES), end(SORT_FIELD_NAMES), [&](const auto& f) { return field == f.first; });
+        if (known == end(SORT_FIELD_NAMES)) return false;
+        spec.push_back({known->second, descending});
+        if (comma == string_view::npos) return true;
+        text.remove_prefix(comma + 1);
+    }
+}
+
+// Writes the order-preserving word of every row for field `f` of `spec` into words[i * k + f]
+void fillSortWords(const vector<SortKey>& spec, int f, const vector<int>& rows, vector<uint64_t>& words, int threads) {
+    int n = rows.size(), k = spec.size();
+    vector<uint64_t> rankOf;     // bank ID or name ID -> rank of the string
+    unordered_map<string_view, int> nameIds;
+    vector<int> nameOfRow;
+    vector<string_view> distinct;
+    if (spec[f].field == FIELD_BANK) {
+        for (int id = 0; id < bankIndex.bankCount(); id++) distinct.push_back(bankIndex.name(id));
+    } else if (spec[f].field == FIELD_NAME) {
+        nameOfRow.resize(n);
+        for (int i = 0; i < n; i++) {
+            auto it = nameIds.emplace(store.str(store.name[rows[i]]), (int)distinct.size()).first;
+            if (it->second == (int)distinct.size()) distinct.push_back(it->first);
+            nameOfRow[i] = it->second;
+        }
+    }
+    if (!distinct.empty()) {
+        vector<int> byText(distinct.size());
+        iota(byText.begin(), byText.end(), 0);
+        sort(byText.begin(), byText.end(), [&](int a, int b) { return distinct[a] < distinct[b]; });
+        rankOf.resize(distinct.size());
+        for (size_t r = 0; r < byText.size(); r++) rankOf[byText[r]] = r;
+    }
+    const int CHUNK = 1 << 16;
+    parallelFor((n + CHUNK - 1) / CHUNK, threads, [&](int chunk) {
+        for (int i = chunk * CHUNK; i < min(n, (chunk + 1) * CHUNK); i++) {
+            int row = rows[i];
+            long long value = 0;
+            switch (spec[f].field) {
+                case FIELD_NAME: value = rankOf[nameOfRow[i]]; break;
+                case FIELD_BANK: value = rankOf[bankIndex.bankOf(row)]; break;
+                case FIELD_CARD: value = store.cardNo[row]; break;
+                case FIELD_EXPIRY: value = store.expiryMonths[row]; break;
+                case FIELD_BILLING: value = store.billingDate[row]; break;
+                case FIELD_PIN: value = store.pin[row]; break;
+                case FIELD_CREDIT: value = store.creditLimit[row]; break;
+            }
+            uint64_t word = (uint64_t)value ^ (1ULL << 63);   // signed order as unsigned
+            words[(size_t)i * k + f] = spec[f].descending ? ~word : word;
+        }
+    });
+}
+
+// `rows` (live rows, in the order ties should keep) sorted by `spec`
+vector<int> multiKeySort(const vector<SortKey>& spec, const vector<int>& rows, int threads = defaultThreadCount()) {
+    int n = rows.size(), k = spec.size();
+    if (n < 2 || k == 0) return rows;
+    threads = max(1, threads);
+    vector<uint64_t> words((size_t)n * k);
+    for (int f = 0; f < k; f++) fillSortWords(spec, f, rows, words, threads);
+    // Positions into `rows` are sorted; the words decide, and merges keep ties in order
+    auto less = [&](int a, int b) {
+        const uint64_t* x = &words[(size_t)a * k];
+        const uint64_t* y = &words[(size_t)b * k];
+        for (int f = 0; f < k; f++)
+            if (x[f] != y[f]) return x[f] < y[f];
+        return false;
+    };
+    vector<int> order(n), merged(n);
+    iota(order.begin(), order.end(), 0);
+    int runs = max(1, min(threads, n / 1024));
+    vector<int> bounds(runs + 1);
+    for (int r = 0; r <= runs; r++) bounds[r] = (long long)n * r / runs;
+    parallelFor(runs, threads, [&](int r) { stable_sort(order.begin() + bounds[r], order.begin() + bounds[r + 1], less); });
+
+    int grain = max(1024, (n + threads - 1) / threads);
+    while (runs > 1) {
+        struct Piece { int lo, mid, hi, from, to; };   // outputs [from, to) of merging [lo, mid) with [mid, hi)
+        vector<Piece> pieces;
+        vector<int> next{0};
+        for (int r = 0; r < runs; r += 2) {
+            int lo = bounds[r], mid = bounds[min(r + 1, runs)], hi = bounds[min(r + 2, runs)];
+            for (int from = lo; from < hi; from += grain) pieces.push_back({lo, mid, hi, from, min(hi, from + grain)});
+            next.push_back(hi);
+        }
+        parallelFor(pieces.size(), threads, [&](int t) {
+            const Piece& p = pieces[t];
+            const int* a = order.data() + p.lo;
+            const int* b = order.data() + p.mid;
+            int m = p.mid - p.lo, nb = p.hi - p.mid;
+            // How many of the first d outputs come from a (ties go to a, which keeps the merge stable)
+            auto coRank = [&](int d) {
+                int lo = max(0, d - nb), hi = min(d, m);
+                while (lo < hi) {
+                    int i = (lo + hi) / 2;
+                    if (d - i > 0 && !less(b[d - i - 1], a[i])) lo = i + 1;
+                    else hi = i;
+                }
+                return lo;
+            };
+            int i0 = coRank(p.from - p.lo), i1 = coRank(p.to - p.lo);
+            merge(a + i0, a + i1, b + (p.from - p.lo - i0), b + (p.to - p.lo - i1), merged.begin() + p.from, less);
+        });
+        order.swap(merged);
+        bounds = next;
+        runs = bounds.size() - 1;
+    }
+    vector<int> sorted(n);
+    for (int i = 0; i < n; i++) sorted[i] = rows[order[i]];
+    return sorted;
+}
+
+//Binary snapshot: the record columns plus the orders the indexes are built from, written
+//next to the CSV as "<file>.snap". Every section is a flat array at an 8-byte aligned
+//offset recorded in the header, so the file holds no pointers and loading it is a
+//handful of memcpys out of a mapping. The header records the size and modification time
+//of the CSV it came from; a snapshot that no longer matches is ignored and rewritten.
+enum SnapshotSection {
+    SNAP_CARD, SNAP_PIN, SNAP_BILLING, SNAP_EXPIRY_MONTHS, SNAP_CREDIT,
+    SNAP_NAME, SNAP_BANK, SNAP_EXPIRY_DATE, SNAP_BYTES,
+    SNAP_LIST_ORDER,    // live rows in list order
+    SNAP_CARD_ORDER,    // live rows by (cardNo, row): the AVL in-order
+    SNAP_EXPIRY_ORDER,  // live rows by (expiryMonths, row)
+    SNAP_CARD_HEAP, SNAP_CREDIT_HEAP,
+    SNAP_SECTIONS
+};
+const char SNAPSHOT_MAGIC[8] = {'C', 'X', 'S', 'N', 'A', 'P', '\0', '\0'};
+const uint32_t SNAPSHOT_VERSION = 2;
+const uint32_t SNAPSHOT_ENDIAN = 0x01020304;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version, endian;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    uint64_t rows, liveRows, bytes;
+    uint64_t id;            // 0 for a plain parse of the CSV, else set by log compaction
+    uint64_t foldedBase;    // the log this snapshot absorbed (its base ID) ...
+    uint64_t foldedCount;   // ... and how many of its records
+    uint64_t checksum;      // over everything after the header
+    uint64_t offset[SNAP_SECTIONS], length[SNAP_SECTIONS];
+};
+
+// Size and modification time (at the file system's full resolution) of a file; false
+// if it cannot be read
+bool fileStamp(const string& path, uint64_t& size, int64_t& time) {
+    error_code error;
+    size = filesystem::file_size(path, error);
+    if (error) return false;
+    time = filesystem::last_write_time(path, error).time_since_epoch().count();
+    return !error;
+}
+
+// 64-bit words at a time; a trailing partial word is zero-padded
+uint64_t snapshotChecksum(const char* data, size_t size) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        h = (h ^ word) * 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 32;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data + i, size - i);
+    h = (h ^ tail ^ size) * 0xC4CEB9FE1A85EC53ULL;
+    return h ^ (h >> 29);
+}
+
+string snapshotPath(const string& fileLocation) { return fileLocation + ".snap"; }
+
+// Where a snapshot's contents came from, relative to the write-ahead log
+struct SnapshotLineage {
+    uint64_t id = 0, foldedBase = 0, foldedCount = 0;
+};
+
+bool saveSnapshot(const string& fileLocation, const SnapshotLineage& lineage = SnapshotLineage()) {
+    SnapshotHeader header = {};
+    memcpy(header.magic, SNAPSHOT_MAGIC, 8);
+    header.version = SNAPSHOT_VERSION;
+    header.endian = SNAPSHOT_ENDIAN;
+    header.id = lineage.id;
+    header.foldedBase = lineage.foldedBase;
+    header.foldedCount = lineage.foldedCount;
+    if (!fileStamp(fileLocation, header.sourceSize, header.sourceTime)) return false;
+    int rows = store.size();
+    header.rows = rows;
+    header.bytes = store.bytes.size();
+
+    vector<int> listOrder, cardOrder, expiryOrder;
+    for (Node* p = head; p; p = p->next) listOrder.push_back(p->row);
+    header.liveRows = listOrder.size();
+    for (AVLRange range(avlRoot, LLONG_MIN, LLONG_MAX); range.valid(); range.next()) cardOrder.push_back(range.row());
+    for (AVLRange range(expiryRoot, LLONG_MIN, LLONG_MAX); range.valid(); range.next()) expiryOrder.push_back(range.row());
+    if (cardOrder.size() != listOrder.size() || expiryOrder.size() != listOrder.size()) return false;
+
+    const void* data[SNAP_SECTIONS] = {
+        store.cardNo.data(), store.pin.data(), store.billingDate.data(), store.expiryMonths.data(), store.creditLimit.data(),
+        store.name.data(), store.bank.data(), store.expiryDate.data(), store.bytes.data(),
+        listOrder.data(), cardOrder.data(), expiryOrder.data(), cardHeap.heap.data(), creditHeap.heap.data()};
+    size_t live = listOrder.size();
+    size_t length[SNAP_SECTIONS] = {
+        rows * sizeof(long long), rows * sizeof(int), rows * sizeof(int), rows * sizeof(int), rows * sizeof(int),
+        rows * sizeof(StrRef), rows * sizeof(StrRef), rows * sizeof(StrRef), store.bytes.size(),
+        live * sizeof(int), live * sizeof(int), live * sizeof(int), cardHeap.heap.size() * sizeof(int), creditHeap.heap.size() * sizeof(int)};
+    vector<char> body;
+    for (int i = 0; i < SNAP_SECTIONS; i++) {
+        body.resize((body.size() + 7) & ~(size_t)7);
+        header.offset[i] = sizeof(SnapshotHeader) + body.size();
+        header.length[i] = length[i];
+        body.insert(body.end(), (const char*)data[i], (const char*)data[i] + length[i]);
+    }
+    header.checksum = snapshotChecksum(body.data(), body.size());
+
+    // Write beside the target and rename, so a reader never sees half a snapshot
+    string path = snapshotPath(fileLocation), temporary = path + ".tmp";
+    {
+        ofstream out(temporary, ios::binary | ios::trunc);
+        out.write((const char*)&header, sizeof(header));
+        out.write(body.data(), body.size());
+        if (!out) {
+            out.close();
+            remove(temporary.c_str());
+            return false;
+        }
+    }
+    remove(path.c_str());
+    return rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+// Loads records, list and indexes from the snapshot of `fileLocation` into an empty
+// program. Returns false, changing nothing, when there is no usable snapshot: missing,
+// corrupt, from another build, or older than the CSV. `lineage` is filled in whenever
+// the header could be read, even if the snapshot turns out to be stale.
+bool loadSnapshot(const string& fileLocation, SnapshotLineage* lineage = nullptr) {
+    ScopedTimer timer(OP_LOAD_SNAPSHOT);
+    if (head || store.size()) return false;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (!fileStamp(fileLocation, sourceSize, sourceTime)) return false;
+    MappedFile file(snapshotPath(fileLocation));
+    if (!file.data || file.size < sizeof(SnapshotHeader)) return false;
+    SnapshotHeader header;
+    memcpy(&header, file.data, sizeof(header));
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, 8) != 0 || header.version != SNAPSHOT_VERSION || header.endian != SNAPSHOT_ENDIAN)
+        return false;
+    if (lineage) *lineage = SnapshotLineage{header.id, header.foldedBase, header.foldedCount};
+    if (header.sourceSize != sourceSize || header.sourceTime != sourceTime) return false;
+    uint64_t rows = header.rows, live = header.liveRows;
+    if (rows > INT_MAX || live > rows) return false;
+    uint64_t expected[SNAP_SECTIONS] = {
+        rows * sizeof(long long), rows * sizeof(int), rows * sizeof(int), rows * sizeof(int), rows * sizeof(int),
+        rows * sizeof(StrRef), rows * sizeof(StrRef), rows * sizeof(StrRef), header.bytes,
+        live * sizeof(int), live * sizeof(int), live * sizeof(int), live * sizeof(int), live * sizeof(int)};
+    for (int i = 0; i < SNAP_SECTIONS; i++)
+        if (header.length[i] != expected[i] || header.offset[i] % 8 || header.offset[i] > file.size
+            || header.length[i] > file.size - header.offset[i])
+            return false;
+    if (snapshotChecksum(file.data + sizeof(header), file.size - sizeof(header)) != header.checksum) return false;
+    auto section = [&](int i) { return file.data + header.offset[i]; };
+    const int* order[SNAP_SECTIONS] = {};
+    for (int i = SNAP_LIST_ORDER; i < SNAP_SECTIONS; i++) {
+        order[i] = (const int*)section(i);
+        for (uint64_t j = 0; j < live; j++)
+            if (order[i][j] < 0 || (uint64_t)order[i][j] >= rows) return false;
+    }
+
+    store.resize(rows, header.bytes);
+    memcpy(store.cardNo.data(), section(SNAP_CARD), header.length[SNAP_CARD]);
+    memcpy(store.pin.data(), section(SNAP_PIN), header.length[SNAP_PIN]);
+    memcpy(store.billingDate.data(), section(SNAP_BILLING), header.length[SNAP_BILLING]);
+    memcpy(store.expiryMonths.data(), section(SNAP_EXPIRY_MONTHS), header.length[SNAP_EXPIRY_MONTHS]);
+    memcpy(store.creditLimit.data(), section(SNAP_CREDIT), header.length[SNAP_CREDIT]);
+    memcpy(store.name.data(), section(SNAP_NAME), header.length[SNAP_NAME]);
+    memcpy(store.bank.data(), section(SNAP_BANK), header.length[SNAP_BANK]);
+    memcpy(store.expiryDate.data(), section(SNAP_EXPIRY_DATE), header.length[SNAP_EXPIRY_DATE]);
+    memcpy(store.bytes.data(), section(SNAP_BYTES), header.length[SNAP_BYTES]);
+
+    // Same list and History the CSV loader would have produced
+    for (uint64_t i = 0; i < live; i++) {
+        int row = order[SNAP_LIST_ORDER][i];
+        Node* node = newNode(row);
+        store.node[row] = node;
+        if (!head) head = tail = node;
+        else {
+            node->prev = tail;
+            tail->next = node;
+            tail = node;
+            History::stack.push(row);
+        }
+    }
+    store.liveRows = live;
+
+    bstPool.reset();
+    bstRoot = buildBSTSorted(order[SNAP_CARD_ORDER], live);
+    avlPool.reset();
+    avlRoot = buildAVLSorted(order[SNAP_CARD_ORDER], live, cardKey);
+    expiryRoot = buildAVLSorted(order[SNAP_EXPIRY_ORDER], live, expiryKey);
+    cardIndex.invalidate();
+    cardHeap.assign(order[SNAP_CARD_HEAP], live);
+    creditHeap.assign(order[SNAP_CREDIT_HEAP], live);
+    rebuildHashTables();
+    pinView.invalidate();
+    bankIndex.rebuild();
+    nameIndex.rebuild();
+    return true;
+}
+
+//Log replay and compaction
+string logPath(const string& fileLocation) { return fileLocation + ".wal"; }
+
+// Starts an empty log at `path` over `base`, stamped with the CSV at `fileLocation`
+bool writeLogHeader(const string& path, uint64_t base, const string& fileLocation) {
+    LogHeader header = {};
+    memcpy(header.magic, LOG_MAGIC, 8);
+    header.version = LOG_VERSION;
+    header.endian = SNAPSHOT_ENDIAN;
+    header.base = base;
+    if (!fileStamp(fileLocation, header.sourceSize, header.sourceTime)) return false;
+    string temporary = path + ".tmp";
+    {
+        ofstream out(temporary, ios::binary | ios::trunc);
+        out.write((const char*)&header, sizeof(header));
+        if (!out) return false;
+    }
+    remove(path.c_str());
+    return rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+// Applies one logged change; false if it does not fit the current state
+bool applyLogRecord(const char* body, size_t size) {
+    auto take = [&](void* out, size_t n) {
+        if (size < n) return false;
+        memcpy(out, body, n);
+        body += n;
+        size -= n;
+        return true;
+    };
+    auto takeString = [&](string_view& out) {
+        uint16_t length;
+        if (!take(&length, 2) || size < length) return false;
+        out = string_view(body, length);
+        body += length;
+        size -= length;
+        return true;
+    };
+    uint8_t type;
+    if (!take(&type, 1)) return false;
+    if (type == LOG_ADD) {
+        long long cardNo;
+        int billingDate, pin, creditLimit;
+        string_view name, bank, expiryDate;
+        if (!take(&cardNo, 8) || !take(&billingDate, 4) || !take(&pin, 4) || !take(&creditLimit, 4)
+            || !takeString(name) || !takeString(bank) || !takeString(expiryDate))
+            return false;
+        // The views point into the log, not the store, so appending cannot invalidate them
+        addNode(name, bank, expiryDate, cardNo, billingDate, pin, creditLimit);
+        return true;
+    }
+    if (type == LOG_REMOVE) {
+        int row;
+        if (!take(&row, 4) || !store.isLive(row)) return false;
+        removeRow(row);
+        return true;
+    }
+    return false;
+}
+
+// Header of the log at `path`; false if it is missing or not a log
+bool readLogHeader(const string& path, LogHeader& header) {
+    ifstream in(path, ios::binary);
+    if (!in.read((char*)&header, sizeof(header))) return false;
+    return memcmp(header.magic, LOG_MAGIC, 8) == 0 && header.version == LOG_VERSION && header.endian == SNAPSHOT_ENDIAN;
+}
+
+// Applies the records of the log at `path` after the first `skip`, in order. Stops at
+// the first torn or corrupt record; `validBytes` and `validRecords` describe the good
+// prefix, and `fileBytes` the whole file.
+void replayLog(const string& path, uint64_t skip, uint64_t& validBytes, uint64_t& validRecords, uint64_t& fileBytes) {
+    MappedFile file(path);
+    fileBytes = file.size;
+    validBytes = validRecords = 0;
+    if (!file.data || file.size < sizeof(LogHeader)) return;
+    size_t pos = sizeof(LogHeader);
+    wal.pause(true);
+    while (pos + 8 <= file.size) {
+        uint32_t length, checksum;
+        memcpy(&length, file.data + pos, 4);
+        memcpy(&checksum, file.data + pos + 4, 4);
+        if (length == 0 || length > file.size - pos - 8) break;
+        const char* body = file.data + pos + 8;
+        if (logChecksum(body, length) != checksum) break;
+        if (validRecords >= skip && !applyLogRecord(body, length)) break;
+        pos += 8 + length;
+        validRecords++;
+    }
+    wal.pause(false);
+    validBytes = pos;
+}
+
+// Cuts a torn tail off the log by rewriting its good prefix
+bool truncateLog(const string& path, uint64_t validBytes) {
+    string temporary = path + ".tmp";
+    {
+        MappedFile file(path);
+        if (!file.data || file.size < validBytes) return false;
+        ofstream out(temporary, ios::binary | ios::trunc);
+        out.write(file.data, validBytes);
+        if (!out) return false;
+    }
+    remove(path.c_str());
+    return rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+uint64_t newSnapshotId() {
+    uint64_t id = chrono::system_clock::now().time_since_epoch().count() ^ ((uint64_t)chrono::steady_clock::now().time_since_epoch().count() << 21);
+    id ^= id >> 33;
+    id *= 0xFF51AFD7ED558CCDULL;
+    id ^= id >> 33;
+    return id ? id : 1;
+}
+
+// Folds the first `count` records of the log with base `base` (everything applied so
+// far) into a new snapshot, then starts an empty log on top of it. The snapshot records
+// what it absorbed, so a crash between the two steps is repaired at the next start
+// instead of replaying those changes twice.
+bool compactLog(const string& fileLocation, uint64_t base, uint64_t count) {
+    wal.sync();
+    SnapshotLineage lineage{newSnapshotId(), base, count};
+    if (!saveSnapshot(fileLocation, lineage)) return false;
+    wal.close();
+    string path = logPath(fileLocation);
+    if (!writeLogHeader(path, lineage.id, fileLocation)) return false;
+    return wal.openForAppend(path, lineage.id, 0);
+}
+
+// Moves a file that no longer fits the data out of the way, keeping it for inspection
+void setAside(const string& path, const string& what) {
+    string stale = path + ".stale";
+    remove(stale.c_str());
+    if (rename(path.c_str(), stale.c_str()) == 0)
+        cerr << what << " " << path << " does not match the current data; kept as " << stale << "\n";
+}
+
+const uint64_t COMPACT_LOG_BYTES = 1 << 24;
+
+// Startup: the snapshot (or the CSV), then the log on top of it. Leaves the log open
+// for appends, unless it cannot be trusted against what was loaded.
+void openStore(const string& fileLocation, bool useSnapshot) {
+    SnapshotLineage lineage;
+    bool fromSnapshot = useSnapshot && loadSnapshot(fileLocation, &lineage);
+    string path = logPath(fileLocation);
+    LogHeader header;
+    bool hasLog = readLogHeader(path, header);
+    uint64_t base = hasLog ? header.base : 0;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (hasLog && !(fileStamp(fileLocation, sourceSize, sourceTime) && header.sourceSize == sourceSize
+                    && header.sourceTime == sourceTime)) {
+        // The CSV was edited under the log, so its row IDs may now name other records.
+        // An empty log is simply started again.
+        error_code error;
+        if (filesystem::file_size(path, error) <= sizeof(LogHeader)) remove(path.c_str());
+        else setAside(path, "Change log");
+        hasLog = false;
+        base = 0;
+    }
+    if (!fromSnapshot) {
+        if (!useSnapshot && hasLog && base != 0) {
+            // The log sits on a compacted snapshot we were told not to use
+            beginBulkLoad();
+            loadMappedFile(fileLocation);
+            endBulkLoad();
+            cerr << "Change log " << path << " needs the snapshot; changes in this session will not be saved\n";
+            return;
+        }
+        // A compacted snapshot holds changes the CSV lacks; never overwrite it silently
+        if (lineage.id) setAside(snapshotPath(fileLocation), "Snapshot");
+        lineage = SnapshotLineage();
+        beginBulkLoad();
+        bool loaded = loadMappedFile(fileLocation);
+        endBulkLoad();
+        if (loaded && useSnapshot && !saveSnapshot(fileLocation))
+            cerr << "Could not write snapshot " << snapshotPath(fileLocation) << "\n";
+    }
+
+    uint64_t skip = 0;
+    if (hasLog && base != lineage.id) {
+        if (lineage.id && base == lineage.foldedBase) skip = lineage.foldedCount;   // compaction was cut short
+        else {
+            setAside(path, "Change log");
+            hasLog = false;
+        }
+    } else if (!hasLog) {
+        MappedFile existing(path);
+        if (existing.isOpen()) setAside(path, "Change log");
+    }
+    if (!hasLog) {
+        if (writeLogHeader(path, lineage.id, fileLocation)) wal.openForAppend(path, lineage.id, 0);
+        else cerr << "Could not create change log " << path << "\n";
+        return;
+    }
+
+    uint64_t validBytes, validRecords, fileBytes;
+    replayLog(path, skip, validBytes, validRecords, fileBytes);
+    if (validBytes < fileBytes) {
+        cerr << "Change log " << path << ": ignoring a damaged tail after " << validRecords << " records\n";
+        truncateLog(path, validBytes);
+    }
+    if (useSnapshot && (skip || validBytes >= COMPACT_LOG_BYTES)) {
+        if (!compactLog(fileLocation, base, validRecords)) cerr << "Could not compact change log " << path << "\n";
+    } else if (!wal.openForAppend(path, base, validRecords))
+        cerr << "Could not open change log " << path << "\n";
+}
+
+//Benchmarks
+double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+struct MemoryUsage {
+    size_t resident = 0, peakResident = 0;
+};
+MemoryUsage memoryUsage() {
+    MemoryUsage usage;
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        usage.resident = counters.WorkingSetSize;
+        usage.peakResident = counters.PeakWorkingSetSize;
+    }
+#else
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) usage.resident = stoull(line.substr(6)) * 1024;
+        if (line.rfind("VmHWM:", 0) == 0) usage.peakResident = stoull(line.substr(6)) * 1024;
+    }
+    if (!usage.peakResident) {
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+#ifdef __APPLE__
+        usage.peakResident = ru.ru_maxrss;
+#else
+        usage.peakResident = ru.ru_maxrss * 1024;
+#endif
+    }
+#endif
+    return usage;
+}
+
+template <typename T>
+void printPoolStats(const string& label, const Pool<T>& pool) {
+    auto st = pool.stats();
+    cout << label << ": " << st.live << " live, " << st.created << " created (" << st.reused << " from free list), "
+         << st.slabs << " slab allocations, " << st.bytes / (1024.0 * 1024.0) << " MB reserved\n";
+}
+void printMemoryUsage(const string& label) {
+    MemoryUsage usage = memoryUsage();
+    cout << label << ": RSS " << usage.resident / (1024.0 * 1024.0) << " MB, peak "
+         << usage.peakResident / (1024.0 * 1024.0) << " MB\n";
+}
+
+// Height of a plain BST (not stored in its nodes), walked without recursion
+int bstHeight(BST* root, int& nodes) {
+    int height = 0;
+    nodes = 0;
+    vector<pair<BST*, int>> pending;
+    if (root) pending.push_back({root, 1});
+    while (!pending.empty()) {
+        auto [node, depth] = pending.back();
+        pending.pop_back();
+        nodes++;
+        height = max(height, depth);
+        if (node->left) pending.push_back({node->left, depth + 1});
+        if (node->right) pending.push_back({node->right, depth + 1});
+    }
+    return height;
+}
+
+// Operation latencies and index health, as tab-separated lines:
+//     latency  operation  count  mean  p50  p90  p99  p99.9  max   (ns)
+//     probe    length     keys                 (PIN index probe-length distribution)
+//     height   tree       height  nodes  log2(nodes)
+//     bytes    structure  bytes
+void writeMetrics(ostream& out) {
+    out << "# latency\toperation\tcount\tmean_ns\tp50_ns\tp90_ns\tp99_ns\tp999_ns\tmax_ns\n";
+    for (int op = 0; op < OPERATION_COUNT; op++) {
+        const LatencyHistogram& h = latencies[op];
+        if (!h.count()) continue;
+        out << "latency\t" << OPERATION_NAMES[op] << "\t" << h.count() << "\t" << (uint64_t)h.mean() << "\t" << h.percentile(0.5)
+            << "\t" << h.percentile(0.9) << "\t" << h.percentile(0.99) << "\t" << h.percentile(0.999) << "\t" << h.maximum() << "\n";
+    }
+    PinIndex::Stats st = pinIndex.stats();
+    out << "# probe\tlength\tkeys (PIN index: " << st.keys << " keys, " << st.capacity << " slots, load "
+        << (st.capacity ? (double)(st.keys + st.tombstones) / st.capacity : 0.0) << ")\n";
+    for (size_t i = 0; i < st.probeLengths.size(); i++)
+        if (st.probeLengths[i]) out << "probe\t" << i + 1 << "\t" << st.probeLengths[i] << "\n";
+    // An AVL tree stays under 1.44 log2(n + 2); the plain BST has no such bound
+    out << "# height\ttree\theight\tnodes\tlog2_nodes\n";
+    int bstNodes;
+    int bstDepth = bstHeight(bstRoot, bstNodes);
+    auto heightLine = [&](const char* tree, int treeHeight, int nodes) {
+        out << "height\t" << tree << "\t" << treeHeight << "\t" << nodes << "\t" << (nodes ? log2((double)nodes) : 0.0) << "\n";
+    };
+    heightLine("bst_card", bstDepth, bstNodes);
+    heightLine("avl_card", height(avlRoot), size(avlRoot));
+    heightLine("avl_expiry", height(expiryRoot), size(expiryRoot));
+    out << "# bytes\tstructure\tbytes\n";
+    auto bytesLine = [&](const char* structure, size_t bytes) { out << "bytes\t" << structure << "\t" << bytes << "\n"; };
+    bytesLine("record_store", store.bytesUsed());
+    bytesLine("list_nodes", nodePool.stats().bytes);
+    bytesLine("bst", bstPool.stats().bytes);
+    bytesLine("avl_card_and_expiry", avlPool.stats().bytes);
+    bytesLine("card_index", cardIndex.bytesUsed());
+    bytesLine("pin_index", pinIndex.bytesUsed());
+    bytesLine("pin_view", pinView.bytesUsed());
+    bytesLine("bank_index", bankIndex.bytesUsed());
+    bytesLine("name_index", nameIndex.bytesUsed());
+    bytesLine("bank_graphs", bankGraphs.bytesUsed());
+    bytesLine("card_heap", cardHeap.bytesUsed());
+    bytesLine("credit_heap", creditHeap.bytesUsed());
+    bytesLine("process_rss", memoryUsage().resident);
+}
+
+// Loads a file, then times index rebuilds and list teardown, reporting pool and RSS figures
+int benchmarkAllocations(const string& fileLocation, int rebuilds = 3) {
+    printMemoryUsage("Start");
+    auto start = chrono::steady_clock::now();
+    beginBulkLoad();
+    if (!loadMappedFile(fileLocation)) return 1;
+    endBulkLoad();
+    cout << "Load + index build: " << secondsSince(start) << " s\n";
+    printMemoryUsage("Loaded");
+    printPoolStats("Node pool", nodePool);
+    printPoolStats("BST pool", bstPool);
+    printPoolStats("AVL pool", avlPool);
+
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < rebuilds; i++) buildIndexes();
+    cout << "Index rebuild: " << secondsSince(start) / rebuilds << " s each\n";
+    printPoolStats("BST pool", bstPool);
+    printPoolStats("AVL pool", avlPool);
+
+    start = chrono::steady_clock::now();
+    for (Node* p = head; p;) {
+        Node* next = p->next;
+        nodePool.destroy(p);
+        p = next;
+    }
+    head = tail = nullptr;
+    cout << "List teardown: " << secondsSince(start) << " s\n";
+    printPoolStats("Node pool", nodePool);
+    printMemoryUsage("End");
+    return 0;
+}
+
+// Tokenizes the file with the Queue<Queue<string>> path and with the mapped path.
+// Only field extraction is timed; no records are built by either side.
+int benchmarkIngest(const string& fileLocation, int repetitions = 3) {
+    MappedFile file(fileLocation);
+    if (!file.isOpen()) {
+        cerr << "File cannot be opened: " << fileLocation << endl;
+        return 1;
+    }
+    double megabytes = file.size / (1024.0 * 1024.0);
+    double bestQueue = 1e300, bestMapped = 1e300;
+    long long rowsQueue = 0, rowsMapped = 0, checksum = 0;
+    for (int rep = 0; rep < repetitions; rep++) {
+        auto start = chrono::steady_clock::now();
+        Queue<Queue<string>> rows = parseFile(fileLocation);
+        rowsQueue = 0;
+        while (!rows.isEmpty()) {
+            Queue<string> row = rows.dequeue();
+            string bank = getAttribute(row, 2);
+            long long cardNo = stoll(getAttribute(row, 3));
+            string name = getAttribute(row, 4);
+            string expiryDate = getAttribute(row, 7);
+            int billingDate = stoi(getAttribute(row, 8));
+            int pin = stoi(getAttribute(row, 9));
+            checksum += cardNo + billingDate + pin + bank.size() + name.size() + expiryDate.size();
+            rowsQueue++;
+        }
+        bestQueue = min(bestQueue, secondsSince(start));
+
+        start = chrono::steady_clock::now();
+        MappedFile mapped(fileLocation);
+        rowsMapped = 0;
+        if (mapped.data) {
+            forEachRowView(skipHeader(mapped), mapped.end(), [&](const RowView& row) {
+                checksum -= row.cardNo + row.billingDate + row.pin + row.bank.size() + row.name.size() + row.expiryDate.size();
+                rowsMapped++;
+            });
+        }
+        bestMapped = min(bestMapped, secondsSince(start));
+    }
+    cout << "Ingest benchmark: " << fileLocation << " (" << megabytes << " MB, best of " << repetitions << ")\n";
+    cout << "Queue<Queue<string>>: " << rowsQueue << " rows, " << bestQueue << " s, "
+         << megabytes / bestQueue << " MB/s, " << rowsQueue / bestQueue << " rows/s\n";
+    cout << "Memory-mapped views:  " << rowsMapped << " rows, " << bestMapped << " s, "
+         << megabytes / bestMapped << " MB/s, " << rowsMapped / bestMapped << " rows/s\n";
+    cout << "Speedup: " << bestQueue / bestMapped << "x" << (checksum ? " (checksum mismatch!)" : "") << "\n";
+    return checksum ? 1 : 0;
+}
+
+// Times BST, AVL and the Eytzinger card index on the same queries: half are cards
+// present in the file, half are absent
+int benchmarkCardLookups(const string& fileLocation, int queries = 1000000) {
+    beginBulkLoad();
+    if (!loadMappedFile(fileLocation)) return 1;
+    endBulkLoad();
+    if (!store.liveRows) {
+        cerr << "No records in " << fileLocation << endl;
+        return 1;
+    }
+    vector<long long> cardNos(queries);
+    unsigned long long state = 88172645463325252ULL;
+    for (int i = 0; i < queries; i++) {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        long long cardNo = store.cardNo[state % store.size()];
+        cardNos[i] = (i & 1) ? cardNo + 1 : cardNo;
+    }
+    auto start = chrono::steady_clock::now();
+    cardIndex.size();
+    cout << "Card lookup benchmark: " << fileLocation << " (" << store.liveRows << " cards, " << queries << " queries)\n";
+    cout << "Eytzinger build: " << secondsSince(start) << " s\n";
+
+    vector<int> found(queries);
+    auto run = [&](const char* label, auto lookup) {
+        auto start = chrono::steady_clock::now();
+        lookup();
+        double seconds = secondsSince(start);
+        long long hits = 0;
+        for (int row : found) hits += row != -1;
+        cout << label << seconds * 1e9 / queries << " ns/lookup, " << hits << " hits\n";
+        return found;
+    };
+    vector<int> expected = run("BST:               ", [&] { for (int i = 0; i < queries; i++) found[i] = searchBST(bstRoot, cardNos[i]); });
+    run("AVL:               ", [&] { for (int i = 0; i < queries; i++) found[i] = searchAVL(avlRoot, cardNos[i]); });
+    vector<int> single = run("Eytzinger:         ", [&] { for (int i = 0; i < queries; i++) found[i] = cardIndex.find(cardNos[i]); });
+    vector<int> batched = run("Eytzinger batched: ", [&] { cardIndex.findBatch(cardNos.data(), queries, found.data()); });
+    for (int i = 0; i < queries; i++)
+        if ((expected[i] == -1) != (single[i] == -1) || single[i] != batched[i]) {
+            cout << "Mismatch on card " << cardNos[i] << "\n";
+            return 1;
+        }
+    return 0;
+}
+
+// Prints the rows of one range of an ordered index, preceded by the count. The range is
+// walked a chunk at a time between prints, so memory stays flat however many rows match
+// and only the count and the walk are timed.
+void printRange(AVL* root, long long lo, long long hi, Operation operation) {
+    const int CHUNK = 256;
+    int rows[CHUNK];
+    auto start = chrono::steady_clock::now();
+    int count = countAVL(root, lo, hi);
+    AVLRange range(root, lo, hi);
+    uint64_t nanos = nanosSince(start);
+    cout << count << " matching cards\n";
+    while (range.valid()) {
+        start = chrono::steady_clock::now();
+        int n = 0;
+        for (; n < CHUNK && range.valid(); range.next()) rows[n++] = range.row();
+        nanos += nanosSince(start);
+        for (int i = 0; i < n; i++) {
+            Node* node = store.node[rows[i]];
+            cout<<"Card Holder Name: "<<node->name()<<", Issuing Bank: "<<node->bank()<<", Card Number: "<<node->cardNo()<<", Card Expiry Date: "<<node->expiryDate()<<"\n";
+        }
+    }
+    latencies[operation].record(nanos);
+}
+
+void printTopK(const Heap& ranked) {
+    int k;
+    cout << "How many cards? ";
+    cin >> k;
+    vector<int> rows = timed(OP_TOP_K, [&] { return ranked.topK(k); });
+    if (rows.empty()) cout << "Heap empty!\n";
+    for (int row : rows)
+        cout << "Card: " << store.cardNo[row] << ", Credit Limit: " << store.creditLimit[row] << " (" << store.node[row]->name() << ")\n";
+}
+
+// Checks the closed-form MST weight against the dense Prim and Kruskal on every bank of
+// a file (at most denseCards cards each, to keep O(n^2) in check), then times it on
+// `cards` random billing days (1-31) with no file involved
+int benchmarkMST(const string& fileLocation, long long cards = 10000000, int denseCards = 2000) {
+    beginBulkLoad();
+    if (!loadMappedFile(fileLocation)) return 1;
+    endBulkLoad();
+    bool same = true;
+    double denseSeconds = 0, closedSeconds = 0;
+    for (int bank = 0; bank < bankIndex.bankCount(); bank++) {
+        vector<int> rows = bankIndex.rows(bank);
+        if ((int)rows.size() > denseCards) rows.resize(denseCards);
+        auto start = chrono::steady_clock::now();
+        long long prim = primMSTDense(rows), kruskal = kruskalMSTDense(rows);
+        denseSeconds += secondsSince(start);
+        start = chrono::steady_clock::now();
+        same = same && primMST(rows) == prim && kruskalMST(rows) == kruskal;
+        closedSeconds += secondsSince(start);
+    }
+    cout << "MST benchmark: " << fileLocation << " (" << bankIndex.bankCount() << " banks, up to " << denseCards << " cards each)\n";
+    cout << "Dense Prim + Kruskal: " << denseSeconds << " s, closed form: " << closedSeconds << " s, totals "
+         << (same ? "match" : "DIFFER") << "\n";
+
+    vector<int> days(cards);
+    unsigned long long state = 88172645463325252ULL;
+    for (auto& day : days) {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        day = 1 + state % 31;
+    }
+    cout << "Synthetic: " << cards << " cards\n";
+    auto start = chrono::steady_clock::now();
+    long long weight = daySpan(cards, [&](int i) { return days[i]; });
+    cout << "MST weight (closed form): " << weight << " in " << secondsSince(start) << " s\n";
+    printMemoryUsage("Memory");
+    return same ? 0 : 1;
+}
+
+//Batch mode: one query per line from a file or stdin, results to stdout. Every output
+//line starts with the query's line number and a tab, then either tab-separated fields
+//or a single word (a count, "not found", "ok", or "error: ..."). Row fields are
+//    card  name  bank  expiry  pin  creditLimit
+//Queries:
+//    card|bst|avl <number>        lowest row with the card (through the Eytzinger index)
+//    pin <pin>                    first row with the PIN
+//    pins <pin>                   every row with the PIN
+//    name <name>                  exact, then any case, then prefix matches
+//    bank <bank>                  every card of the bank
+//    range <lo> <hi>              cards numbered lo..hi, in order
+//    expiry <MM/YYYY> <MM/YYYY>   cards expiring in that window, in order
+//    count-range / count-expiry   the same, count only
+//    top <k> / top-credit <k>     largest card numbers / credit limits
+//    add <name>|<bank>|<MM/YYYY>|<card>|<pin>[|<credit limit>]
+//    remove <card> <pin>
+//    sort <fields> [<count>]      rows ordered by e.g. bank,expiry,card (see parseSortSpec)
+//    scan-pins <pin> [<pin>...]   every row with any of the PINs (column scan)
+//    scan-card <number>           every row with the card (column scan)
+//    metrics                      operation latencies and index health (see writeMetrics)
+//Card lookups are resolved BATCH_BLOCK at a time with interleaved index descents, output
+//is written in large blocks, and changes are synced to the log once per block.
+const int BATCH_BLOCK = 4096;
+const size_t BATCH_FLUSH_BYTES = 1 << 20;
+
+class BatchWriter {
+    string buffer;
+public:
+    BatchWriter() { buffer.reserve(BATCH_FLUSH_BYTES + 4096); }
+    ~BatchWriter() { flush(); }
+    void flush() {
+        fwrite(buffer.data(), 1, buffer.size(), stdout);
+        buffer.clear();
+    }
+    template <typename T>
+    void number(T value) {
+        char digits[24];
+        auto result = to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, result.ptr);
+    }
+    void text(string_view value) { buffer.append(value.data(), value.size()); }
+    void begin(long long line) {
+        number(line);
+        buffer += '\t';
+    }
+    void end() {
+        buffer += '\n';
+        if (buffer.size() >= BATCH_FLUSH_BYTES) flush();
+    }
+    void word(long long line, string_view value) {
+        begin(line);
+        text(value);
+        end();
+    }
+    void count(long long line, long long value) {
+        begin(line);
+        number(value);
+        end();
+    }
+    void row(long long line, int row) {
+        begin(line);
+        number(store.cardNo[row]);
+        buffer += '\t';
+        text(store.str(store.name[row]));
+        buffer += '\t';
+        text(store.str(store.bank[row]));
+        buffer += '\t';
+        text(store.str(store.expiryDate[row]));
+        buffer += '\t';
+        number(store.pin[row]);
+        buffer += '\t';
+        number(store.creditLimit[row]);
+        end();
+    }
+};
+
+// Splits off the first space-separated word of `text`
+string_view nextWord(string_view& text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    size_t end = 0;
+    while (end < text.size() && text[end] != ' ' && text[end] != '\t') end++;
+    string_view word = text.substr(0, end);
+    text.remove_prefix(end);
+    return word;
+}
+string_view trimmed(string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) text.remove_suffix(1);
+    return text;
+}
+
+// Runs one non-card query
+void runBatchQuery(BatchWriter& out, long long line, string_view command, string_view rest) {
+    auto rows = [&](const vector<int>& found) {
+        for (int row : found) out.row(line, row);
+        if (found.empty()) out.word(line, "not found");
+    };
+    auto range = [&](AVL* root, long long lo, long long hi, bool countOnly) {
+        ScopedTimer timer(root == avlRoot ? OP_RANGE_CARD : OP_RANGE_EXPIRY);
+        if (countOnly) out.count(line, countAVL(root, lo, hi));
+        else {
+            bool any = false;
+            for (AVLRange it(root, lo, hi); it.valid(); it.next(), any = true) out.row(line, it.row());
+            if (!any) out.word(line, "not found");
+        }
+    };
+    string_view first = nextWord(rest), second = nextWord(rest);
+    long long a, b;
+    if (command == "pin" || command == "pins") {
+        int pin;
+        if (!parseNumber(first, pin)) return out.word(line, "error: expected a PIN");
+        const int* found = nullptr;
+        int count = timed(OP_SEARCH_PIN_HASH, [&] { return pinIndex.findAll(pin, &found); });
+        if (command == "pin") count = min(count, 1);
+        rows(vector<int>(found, found + count));
+    } else if (command == "name" || command == "bank") {
+        string_view argument = trimmed(string_view(first.data(), rest.data() + rest.size() - first.data()));
+        if (first.empty()) return out.word(line, "error: expected a name");
+        bool byPrefix;
+        if (command == "name") rows(timed(OP_SEARCH_NAME, [&] { return findUsers(argument, byPrefix); }));
+        else rows(timed(OP_SEARCH_BANK, [&] { return getNodesByBank(string(argument)); }));
+    } else if (command == "range" || command == "count-range") {
+        if (!parseNumber(first, a) || !parseNumber(second, b)) return out.word(line, "error: expected two card numbers");
+        range(avlRoot, a, b, command == "count-range");
+    } else if (command == "expiry" || command == "count-expiry") {
+        a = parseExpiryMonths(first);
+        b = parseExpiryMonths(second);
+        if (a < 0 || b < 0) return out.word(line, "error: expected two MM/YYYY dates");
+        range(expiryRoot, a, b, command == "count-expiry");
+    } else if (command == "top" || command == "top-credit") {
+        int k;
+        if (!parseNumber(first, k)) return out.word(line, "error: expected a count");
+        rows(timed(OP_TOP_K, [&] { return (command == "top" ? cardHeap : creditHeap).topK(k); }));
+    } else if (command == "remove") {
+        int pin;
+        if (!parseNumber(first, a) || !parseNumber(second, pin)) return out.word(line, "error: expected a card number and a PIN");
+        int row = findCardWithPin(a, pin);
+        if (row == -1) return out.word(line, "not found");
+        removeRow(row);
+        out.word(line, "ok");
+    } else if (command == "add") {
+        string_view fields[6];
+        string_view all = trimmed(string_view(first.data(), rest.data() + rest.size() - first.data()));
+        int count = 0;
+        while (count < 6) {
+            size_t bar = all.find('|');
+            fields[count++] = trimmed(all.substr(0, bar));
+            if (bar == string_view::npos) break;
+            all.remove_prefix(bar + 1);
+        }
+        long long cardNo;
+        int pin, creditLimit = 0;
+        if (count < 5 || !parseNumber(fields[3], cardNo) || !parseNumber(fields[4], pin)
+            || (count == 6 && !parseNumber(fields[5], creditLimit)))
+            return out.word(line, "error: expected name|bank|MM/YYYY|card|pin[|credit limit]");
+        time_t now = time(nullptr);
+        // addNode copies the strings into the store before anything else can move them
+        addNode(fields[0], fields[1], fields[2], cardNo, localtime(&now)->tm_mday, pin, creditLimit);
+        out.word(line, "ok");
+    } else if (command == "scan-pins") {
+        vector<int> pins;
+        int pin;
+        string_view list = string_view(first.data(), rest.data() + rest.size() - first.data());
+        for (string_view word = nextWord(list); !word.empty(); word = nextWord(list)) {
+            if (!parseNumber(word, pin)) return out.word(line, "error: expected PINs");
+            pins.push_back(pin);
+        }
+        if (pins.empty()) return out.word(line, "error: expected PINs");
+        rows(timed(OP_SEARCH_PIN_LINEAR, [&] { return scanPins(pins); }));
+    } else if (command == "scan-card") {
+        if (!parseNumber(first, a)) return out.word(line, "error: expected a card number");
+        rows(scanCards(a));
+    } else if (command == "sort") {
+        vector<SortKey> spec;
+        long long limit = LLONG_MAX;
+        if (!parseSortSpec(first, spec) || (!second.empty() && (!parseNumber(second, limit) || limit < 1)))
+            return out.word(line, "error: expected fields such as bank,expiry,card and an optional positive count");
+        vector<int> sorted = timed(OP_SORT_MULTI, [&] { return multiKeySort(spec, listRows()); });
+        if ((long long)sorted.size() > limit) sorted.resize(limit);
+        rows(sorted);
+    } else if (command == "metrics") {
+        ostringstream report;
+        writeMetrics(report);
+        istringstream lines(report.str());
+        string text;
+        while (getline(lines, text)) out.word(line, text);
+    } else if (command == "card" || command == "bst" || command == "avl") {
+        out.word(line, "error: expected a card number");
+    } else out.word(line, "error: unknown query");
+}
+
+// Reads queries from `queryFile` ("-" for stdin). Returns 1 if the file cannot be read.
+int runBatch(const string& fileLocation, const string& queryFile, bool useSnapshot) {
+    string input;
+    if (queryFile == "-") {
+        char chunk[1 << 16];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), stdin)) > 0) input.append(chunk, n);
+    } else {
+        MappedFile file(queryFile);
+        if (!file.isOpen()) {
+            cerr << "File cannot be opened: " << queryFile << endl;
+            return 1;
+        }
+        if (file.data) input.assign(file.data, file.size);
+    }
+    openStore(fileLocation, useSnapshot);
+
+    BatchWriter out;
+    struct Query {
+        long long line;
+        string_view command, rest;
+        long long cardNo;
+        bool card, mutation;
+    };
+    vector<Query> block;
+    vector<long long> cardNos;
+    vector<int> found;
+    // Card lookups between two changes are resolved together; changes run in line order.
+    // Each change leaves the card index stale, and rebuilding it is O(n), so it is rebuilt
+    // at most once per block; card lookups after a later change go through the AVL tree.
+    auto runBlock = [&]() {
+        bool rebuilt = false;
+        for (size_t i = 0; i < block.size();) {
+            size_t end = i;
+            cardNos.clear();
+            for (; end < block.size() && !block[end].mutation; end++)
+                if (block[end].card) cardNos.push_back(block[end].cardNo);
+            found.resize(cardNos.size());
+            if (!cardNos.empty()) {
+                auto start = chrono::steady_clock::now();
+                if (rebuilt && cardIndex.stale())
+                    for (size_t k = 0; k < cardNos.size(); k++) found[k] = searchAVL(avlRoot, cardNos[k]);
+                else {
+                    rebuilt = rebuilt || cardIndex.stale();
+                    cardIndex.findBatch(cardNos.data(), cardNos.size(), found.data());
+                }
+                latencies[OP_SEARCH_CARD_INDEX].record(nanosSince(start) / cardNos.size(), cardNos.size());
+            }
+            size_t next = 0;
+            for (; i < end; i++) {
+                Query& q = block[i];
+                if (!q.card) runBatchQuery(out, q.line, q.command, q.rest);
+                else if (found[next] == -1) out.word(q.line, "not found"), next++;
+                else out.row(q.line, found[next++]);
+            }
+            if (i < block.size()) {
+                runBatchQuery(out, block[i].line, block[i].command, block[i].rest);
+                i++;
+            }
+        }
+        block.clear();
+        wal.sync();
+    };
+
+    string_view text(input);
+    long long line = 0;
+    while (!text.empty()) {
+        size_t newline = text.find('\n');
+        string_view current = trimmed(text.substr(0, newline));
+        text.remove_prefix(newline == string_view::npos ? text.size() : newline + 1);
+        line++;
+        if (current.empty() || current.front() == '#') continue;
+        Query q{line, nextWord(current), current, 0, false, false};
+        q.mutation = q.command == "add" || q.command == "remove";
+        if (q.command == "card" || q.command == "bst" || q.command == "avl") {
+            string_view number = nextWord(q.rest);
+            q.card = parseNumber(number, q.cardNo);     // a malformed one is reported by runBatchQuery
+        }
+        block.push_back(q);
+        if ((int)block.size() >= BATCH_BLOCK) runBlock();
+    }
+    if (!block.empty()) runBlock();
+    out.flush();
+    wal.close();
+    return 0;
+}
+
+//Synthetic data: writes `rows` records in bank.csv's 11-column layout, streaming through
+//a fixed buffer so any size fits in constant memory. The same seed always gives the
+//same file. Distributions follow the sample: card types and issuing banks in its
+//proportions, Luhn-valid numbers with each network's prefixes and lengths, names from a
+//small pool (so names repeat), PINs drawn partly from a short list of popular ones (so
+//PINs collide far more than uniform 4-digit values would), and a small share of
+//card numbers reissued from recent rows (duplicates).
+struct SplitMix {
+    uint64_t state;
+    SplitMix(uint64_t seed) : state(seed) {}
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    int below(int n) { return (int)(next() % n); }
+    bool chance(double p) { return (next() >> 11) * (1.0 / 9007199254740992.0) < p; }
+};
+
+struct CardType {
+    const char* code;
+    const char* fullName;
+    int weight;
+    int length;
+    vector<const char*> prefixes;
+    vector<pair<const char*, int>> banks;   // issuing bank and its weight
+};
+const vector<CardType> CARD_TYPES = {
+    {"MC", "Master Card", 26, 16, {"51", "52", "53", "54", "55"},
+     {{"Chase", 9}, {"Bank of America", 4}, {"Barclays", 4}, {"Capital One", 4}, {"Citibank", 2}, {"Wells Fargo", 2}, {"GE Capital", 1}}},
+    {"DC", "Diners Club International", 18, 14, {"30", "36", "38"}, {{"Diners Club", 1}}},
+    {"AX", "American Express", 16, 15, {"34", "37"}, {{"American Express", 14}, {"Bank of America", 1}, {"USAA", 1}}},
+    {"JC", "Japan Credit Bureau", 15, 16, {"35"}, {{"JCB", 1}}},
+    {"VI", "Visa", 14, 16, {"4"},
+     {{"Chase", 6}, {"Citibank", 3}, {"Barclays", 1}, {"Capital One", 1}, {"GE Capital", 1}, {"U.S. Bancorp", 1}, {"Cabela's WFB", 1}}},
+    {"DS", "Discover", 11, 16, {"6011", "64", "65"}, {{"Discover", 1}}},
+};
+const vector<const char*> FIRST_NAMES = {
+    "James", "Mary", "John", "Patricia", "Robert", "Jennifer", "Michael", "Linda", "William", "Elizabeth",
+    "David", "Barbara", "Richard", "Susan", "Joseph", "Jessica", "Thomas", "Sarah", "Charles", "Karen",
+    "Christopher", "Nancy", "Daniel", "Lisa", "Matthew", "Betty", "Anthony", "Margaret", "Mark", "Sandra",
+    "Donald", "Ashley", "Steven", "Kimberly", "Paul", "Emily", "Andrew", "Donna", "Joshua", "Michelle",
+    "Kenneth", "Dorothy", "Kevin", "Carol", "Brian", "Amanda", "George", "Melissa", "Edward", "Deborah"};
+const vector<const char*> LAST_NAMES = {
+    "Smith", "Johnson", "Williams", "Brown", "Jones", "Garcia", "Miller", "Davis", "Rodriguez", "Martinez",
+    "Hernandez", "Lopez", "Gonzalez", "Wilson", "Anderson", "Thomas", "Taylor", "Moore", "Jackson", "Martin",
+    "Lee", "Perez", "Thompson", "White", "Harris", "Sanchez", "Clark", "Ramirez", "Lewis", "Robinson",
+    "Walker", "Young", "Allen", "King", "Wright", "Scott", "Torres", "Nguyen", "Hill", "Flores",
+    "Green", "Adams", "Nelson", "Baker", "Hall", "Rivera", "Campbell", "Mitchell", "Carter", "Roberts"};
+const int POPULAR_PINS[] = {1234, 1111, 0, 1212, 7777, 1004, 2000, 4444, 2222, 6969, 9999, 3333, 5555, 6666, 1122, 1313, 8888, 4321, 2001, 1010};
+
+// Random digits after `prefix` up to `length`, the last one a Luhn check digit
+long long luhnCardNumber(SplitMix& rng, const char* prefix, int length) {
+    int digits[19];
+    int n = 0;
+    for (const char* p = prefix; *p; p++) digits[n++] = *p - '0';
+    while (n < length - 1) digits[n++] = rng.below(10);
+    int sum = 0;
+    for (int i = n - 1, doubled = 1; i >= 0; i--, doubled ^= 1) {
+        int d = digits[i] * (doubled ? 2 : 1);
+        sum += d > 9 ? d - 9 : d;
+    }
+    digits[n++] = (10 - sum % 10) % 10;
+    long long number = 0;
+    for (int i = 0; i < n; i++) number = number * 10 + digits[i];
+    return number;
+}
+
+template <typename T>
+const T& pickWeighted(SplitMix& rng, const vector<T>& items, int (*weightOf)(const T&)) {
+    int total = 0;
+    for (const T& item : items) total += weightOf(item);
+    int ticket = rng.below(total);
+    for (const T& item : items) {
+        ticket -= weightOf(item);
+        if (ticket < 0) return item;
+    }
+    return items.back();
+}
+
+const double DUPLICATE_CARD_RATE = 0.005;
+const double POPULAR_PIN_RATE = 0.1;
+
+int generateCsv(const string& fileLocation, long long rows, uint64_t seed = 1) {
+    FILE* out = fopen(fileLocation.c_str(), "wb");
+    if (!out) {
+        cerr << "File cannot be opened: " << fileLocation << endl;
+        return 1;
+    }
+    SplitMix rng(seed);
+    string buffer = "Card Type Code,Card Type Full Name,Issuing Bank,Card Number,Card Holder's Name,CVV/CVV2,Issue Date,Expiry Date,Billing Date,Card PIN,Credit Limit";
+    char line[256];
+    long long recent[1024];     // recently issued (card number, type) pairs for reissues
+    int recentType[1024];
+    long long issued = 0;
+    bool ok = true;
+    for (long long i = 0; i < rows; i++) {
+        int typeIndex;
+        long long cardNo;
+        if (issued && rng.chance(DUPLICATE_CARD_RATE)) {
+            int slot = rng.below(min<long long>(issued, 1024));
+            cardNo = recent[slot];
+            typeIndex = recentType[slot];
+        } else {
+            const CardType& picked = pickWeighted<CardType>(rng, CARD_TYPES, [](const CardType& t) { return t.weight; });
+            typeIndex = &picked - CARD_TYPES.data();
+            cardNo = luhnCardNumber(rng, picked.prefixes[rng.below(picked.prefixes.size())], picked.length);
+            recent[issued % 1024] = cardNo;
+            recentType[issued % 1024] = typeIndex;
+            issued++;
+        }
+        const CardType& type = CARD_TYPES[typeIndex];
+        const char* bank = pickWeighted<pair<const char*, int>>(rng, type.banks, [](const pair<const char*, int>& b) { return b.second; }).first;
+        char name[64];
+        if (rng.chance(0.82))
+            snprintf(name, sizeof(name), "%s %c %s", FIRST_NAMES[rng.below(FIRST_NAMES.size())], 'A' + rng.below(26), LAST_NAMES[rng.below(LAST_NAMES.size())]);
+        else
+            snprintf(name, sizeof(name), "%s %s", FIRST_NAMES[rng.below(FIRST_NAMES.size())], LAST_NAMES[rng.below(LAST_NAMES.size())]);
+        bool amex = type.code[0] == 'A';
+        int cvv = rng.below(amex ? 10000 : 1000);
+        int month = 1 + rng.below(12), issueYear = 2007 + rng.below(11), expiryYear = issueYear + 1 + rng.below(20);
+        int pin = rng.chance(POPULAR_PIN_RATE) ? POPULAR_PINS[rng.below(sizeof(POPULAR_PINS) / sizeof(int))] : rng.below(10000);
+        int length = snprintf(line, sizeof(line), "\n%s,%s,%s,%lld,%s,%0*d,%02d/%d,%02d/%d,%d,%04d,%d",
+                              type.code, type.fullName, bank, cardNo, name, amex ? 4 : 3, cvv, month, issueYear,
+                              month, expiryYear, 1 + rng.below(28), pin, 100 * (100 + rng.below(1891)));
+        buffer.append(line, length);
+        if (buffer.size() >= (1 << 20)) {
+            ok = ok && fwrite(buffer.data(), 1, buffer.size(), out) == buffer.size();
+            buffer.clear();
+        }
+    }
+    ok = ok && fwrite(buffer.data(), 1, buffer.size(), out) == buffer.size();
+    ok = fclose(out) == 0 && ok;
+    if (!ok) cerr << "Write failed: " << fileLocation << endl;
+    return ok ? 0 : 1;
+}
+
+//Scan benchmark: the PIN and card column scans with every kernel set this CPU supports,
+//against a walk of the list, on single-PIN, any-of-4-PINs and card probes
+int benchmarkScans(const string& fileLocation, int queries = 200) {
+    beginBulkLoad();
+    if (!loadMappedFile(fileLocation)) return 1;
+    endBulkLoad();
+    if (!store.liveRows) {
+        cerr << "No records in " << fileLocation << endl;
+        return 1;
+    }
+    SplitMix rng(7);
+    vector<vector<int>> single(queries), anyOf(queries);
+    vector<long long> cards(queries);
+    for (int i = 0; i < queries; i++) {
+        single[i] = {store.pin[rng.below(store.size())]};
+        for (int k = 0; k < 4; k++) anyOf[i].push_back(rng.below(10000));
+        cards[i] = store.cardNo[rng.below(store.size())];
+    }
+    cout << "Scan benchmark: " << fileLocation << " (" << store.liveRows << " rows, " << queries << " queries each)\n";
+    vector<vector<int>> expected(3 * queries);
+    auto listWalk = [&](auto matches, vector<int>& out) {
+        for (Node* p = head; p; p = p->next)
+            if (matches(p)) out.push_back(p->row);
+        sort(out.begin(), out.end());
+    };
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < queries; i++) {
+        listWalk([&](Node* p) { return p->pin() == single[i][0]; }, expected[i]);
+        listWalk([&](Node* p) { return find(anyOf[i].begin(), anyOf[i].end(), p->pin()) != anyOf[i].end(); }, expected[queries + i]);
+        listWalk([&](Node* p) { return p->cardNo() == cards[i]; }, expected[2 * queries + i]);
+    }
+    cout << "List walk: " << secondsSince(start) * 1e3 / (3 * queries) << " ms per query\n";
+    bool same = true;
+    ScanKernels best = scanKernels;
+    for (const ScanKernels& kernels : supportedScanKernels()) {
+        scanKernels = kernels;
+        double seconds[3] = {};
+        for (int i = 0; i < queries; i++) {
+            auto start = chrono::steady_clock::now();
+            same = same && scanPins(single[i]) == expected[i];
+            seconds[0] += secondsSince(start);
+            start = chrono::steady_clock::now();
+            same = same && scanPins(anyOf[i]) == expected[queries + i];
+            seconds[1] += secondsSince(start);
+            start = chrono::steady_clock::now();
+            same = same && scanCards(cards[i]) == expected[2 * queries + i];
+            seconds[2] += secondsSince(start);
+        }
+        cout << "Column scan (" << kernels.name << "): PIN " << seconds[0] * 1e3 / queries << " ms, any of 4 PINs "
+             << seconds[1] * 1e3 / queries << " ms, card " << seconds[2] * 1e3 / queries << " ms per query\n";
+    }
+    scanKernels = best;
+    cout << "Results " << (same ? "match" : "DIFFER") << "\n";
+    return same ? 0 : 1;
+}
+
+//Benchmark suite: times every operation behind the menu on generated files of several
+//sizes and reports ns/op, items/s and peak RSS as JSON or CSV, so runs on two commits
+//can be diffed. Each size runs in its own process (this program with --bench-suite-run),
+//so the peak RSS of a size is not inflated by the sizes before it. Quadratic sorts are
+//skipped above QUADRATIC_SORT_LIMIT rows, and the dense graph references run on the
+//first DENSE_GRAPH_LIMIT cards of the bank.
+const int QUADRATIC_SORT_LIMIT = 20000;
+const int DENSE_GRAPH_LIMIT = 2000;
+
+struct SuiteResult {
+    long long rows;
+    string operation;
+    long long items;
+    double seconds;
+    size_t peakResident;
+};
+
+// Relinks the list in row order, as after a load, so every sort starts from the same input
+void relinkInRowOrder() {
+    Node* prev = nullptr;
+    head = nullptr;
+    for (int row = 0; row < store.size(); row++) {
+        Node* node = store.node[row];
+        if (!node) continue;
+        node->prev = prev;
+        if (prev) prev->next = node;
+        else head = node;
+        prev = node;
+    }
+    if (prev) prev->next = nullptr;
+    tail = prev;
+}
+
+// One size, in the child process: appends "operation items seconds peakRSS" lines to `resultsFile`
+int runSuiteSize(const string& fileLocation, const string& resultsFile) {
+    FILE* results = fopen(resultsFile.c_str(), "ab");
+    if (!results) {
+        cerr << "File cannot be opened: " << resultsFile << endl;
+        return 1;
+    }
+    long long sink = 0;   // folds in every result so no timed call can be optimized away
+    auto record = [&](const char* operation, long long items, double seconds) {
+        fprintf(results, "%s\t%lld\t%.9f\t%zu\n", operation, items, seconds, memoryUsage().peakResident);
+    };
+    auto time = [&](const char* operation, long long items, auto fn) {
+        auto start = chrono::steady_clock::now();
+        fn();
+        record(operation, items, secondsSince(start));
+    };
+
+    auto start = chrono::steady_clock::now();
+    beginBulkLoad();
+    bool loaded = loadMappedFile(fileLocation);
+    bulkLoading = false;
+    record("load_csv", store.size(), secondsSince(start));
+    int n = store.size();
+    if (!loaded || n == 0) {
+        fclose(results);
+        cerr << "No records in " << fileLocation << endl;
+        return 1;
+    }
+    // Index builds, in buildIndexes() order
+    time("build_bst", n, [&] { bstPool.reset(); bstRoot = buildBST(); });
+    time("build_avl", n, [&] { avlPool.reset(); avlRoot = buildAVL(); });
+    time("build_avl_expiry", n, [&] { expiryRoot = buildAVL(expiryKey); });
+    time("build_card_index", n, [&] { cardIndex.invalidate(); sink += cardIndex.size(); });
+    time("build_heap_card", n, [&] { cardHeap.build(); });
+    time("build_heap_credit", n, [&] { creditHeap.build(); });
+    time("rebuild_hash_tables", n, [&] { rebuildHashTables(); });
+    time("build_bank_index", n, [&] { bankIndex.rebuild(); });
+    time("build_name_index", n, [&] { nameIndex.rebuild(); });
+
+    // Lookups: card numbers half present, half absent; PINs, names and banks drawn from rows
+    const int queries = 100000;
+    SplitMix rng(42);
+    vector<long long> cards(queries);
+    vector<int> pins(queries);
+    vector<string> names(queries / 10);
+    for (int i = 0; i < queries; i++) {
+        long long cardNo = store.cardNo[rng.below(n)];
+        cards[i] = (i & 1) ? cardNo + 1 : cardNo;
+        pins[i] = rng.below(10000);
+    }
+    for (string& name : names) name = string(store.str(store.name[rng.below(n)]));
+    vector<int> found(queries);
+    time("search_bst", queries, [&] { for (long long c : cards) sink += searchBST(bstRoot, c); });
+    time("search_avl", queries, [&] { for (long long c : cards) sink += searchAVL(avlRoot, c); });
+    time("search_card_index", queries, [&] { for (long long c : cards) sink += cardIndex.find(c); });
+    time("search_card_index_batch", queries, [&] { cardIndex.findBatch(cards.data(), queries, found.data()); sink += found[0]; });
+    time("search_pin_hash", queries, [&] { for (int pin : pins) sink += pinIndex.find(pin); });
+    time("search_pin_hash_all", queries, [&] {
+        const int* rows;
+        for (int pin : pins) sink += pinIndex.findAll(pin, &rows);
+    });
+    time("search_pin_linear", 1000, [&] { for (int i = 0; i < 1000; i++) sink += linearSearch(pins[i]); });
+    time("build_pin_view", n, [&] { pinView.invalidate(); sink += pinView.sorted().size(); });
+    time("search_pin_binary", queries, [&] { for (int pin : pins) sink += binarySearch(pinView.sorted(), pin); });
+    time("search_name", names.size(), [&] {
+        bool byPrefix;
+        for (const string& name : names) sink += findUsers(name, byPrefix).size();
+    });
+    time("search_bank", 1000, [&] {
+        for (int i = 0; i < 1000; i++) sink += getNodesByBank(string(store.str(store.bank[i % n]))).size();
+    });
+    long long visited = 0;
+    time("range_card_count", queries, [&] {
+        for (int i = 0; i + 1 < queries; i += 2) sink += countAVL(avlRoot, min(cards[i], cards[i + 1]), max(cards[i], cards[i + 1]));
+        for (int i = 0; i + 1 < queries; i += 2) sink += countAVL(avlRoot, cards[i], cards[i] + (1LL << 40));
+    });
+    time("range_expiry_scan", 100, [&] {
+        for (int i = 0; i < 100; i++) {
+            int from = store.expiryMonths[rng.below(n)];
+            for (AVLRange range(expiryRoot, from, from + 11); range.valid(); range.next()) visited++;
+        }
+    });
+    sink += visited;
+    time("top_k_card", 1000, [&] { for (int i = 0; i < 1000; i++) sink += cardHeap.topK(100).size(); });
+    time("top_k_credit", 1000, [&] { for (int i = 0; i < 1000; i++) sink += creditHeap.topK(100).size(); });
+
+    // Sorts by PIN, each from row order
+    if (n <= QUADRATIC_SORT_LIMIT) {
+        time("sort_bubble", n, [&] { bubbleSortList(head); });
+        relinkInRowOrder();
+        time("sort_selection", n, [&] { selectionSortList(head); });
+        relinkInRowOrder();
+        time("sort_insertion", n, [&] { head = insertionSortList(head); restoreBackLinks(); });
+        relinkInRowOrder();
+    }
+    time("sort_merge", n, [&] { head = mergeSortList(head); restoreBackLinks(); });
+    relinkInRowOrder();
+    time("sort_radix_pin", n, [&] { relinkList(sortedRows(pinKey)); });
+    relinkInRowOrder();
+    time("sort_radix_card", n, [&] { relinkList(sortedRows(cardKey)); });
+    relinkInRowOrder();
+    vector<SortKey> reportOrder;
+    parseSortSpec("bank,expiry,card", reportOrder);
+    time("sort_multi_key", n, [&] { relinkList(multiKeySort(reportOrder, listRows())); });
+    relinkInRowOrder();
+
+    // Graph algorithms on the largest bank
+    int bank = 0;
+    for (int id = 1; id < bankIndex.bankCount(); id++)
+        if (bankIndex.rows(id).size() > bankIndex.rows(bank).size()) bank = id;
+    const vector<int>& bankRows = bankIndex.rows(bank);
+    int cardsInBank = bankRows.size();
+    time("build_bank_graph", cardsInBank, [&] { sink += buildBankGraph(cardsInBank).targets.size(); });
+    const CSRGraph& graph = bankGraphs.graph(bank);
+    time("bfs", 10LL * cardsInBank, [&] { for (int i = 0; i < 10; i++) traversal.bfs(graph, 0, [&](int u) { sink += u; }); });
+    time("dfs", 10LL * cardsInBank, [&] { for (int i = 0; i < 10; i++) traversal.dfs(graph, 0, [&](int u) { sink += u; }); });
+    time("dijkstra", 100, [&] {
+        for (int i = 0; i < 100; i++)
+            sink += dijkstraPath(bankRows, store.cardNo[bankRows[rng.below(cardsInBank)]], store.cardNo[bankRows[rng.below(cardsInBank)]]);
+    });
+    time("prim", 10, [&] { for (int i = 0; i < 10; i++) sink += primMST(bankRows); });
+    time("kruskal", 10, [&] { for (int i = 0; i < 10; i++) sink += kruskalMST(bankRows); });
+    // The O(n^2) references on a sample of the bank, so large sizes still report them
+    vector<int> sample(bankRows.begin(), bankRows.begin() + min(cardsInBank, DENSE_GRAPH_LIMIT));
+    time("dijkstra_dense", sample.size(), [&] { sink += dijkstraPathDense(sample, store.cardNo[sample[0]], store.cardNo[sample.back()]); });
+    time("prim_dense", sample.size(), [&] { sink += primMSTDense(sample); });
+    time("kruskal_dense", sample.size(), [&] { sink += kruskalMSTDense(sample); });
+
+    // Changes last, so they do not disturb the measurements above
+    const int changes = 1000;
+    time("add_record", changes, [&] {
+        for (int i = 0; i < changes; i++) {
+            int from = rng.below(n);
+            addNode(string(store.str(store.name[from])), string(store.str(store.bank[from])), string(store.str(store.expiryDate[from])),
+                    store.cardNo[from] + 1, store.billingDate[from], store.pin[from], store.creditLimit[from]);
+        }
+    });
+    time("remove_record", changes, [&] {
+        for (int row = n; row < n + changes; row++) {
+            int found = findCardWithPin(store.cardNo[row], store.pin[row]);
+            if (found != -1) removeRow(found);
+        }
+    });
+    fprintf(results, "# %lld\n", sink);
+    return fclose(results) == 0 ? 0 : 1;
+}
+
+// The running binary, to start it again as a child; argv[0] is only the fallback, since
+// it is a bare name when the program was found through PATH
+string executablePath(const char* argv0) {
+#ifdef _WIN32
+    char path[MAX_PATH];
+    DWORD length = GetModuleFileNameA(nullptr, path, MAX_PATH);
+    if (length > 0 && length < MAX_PATH) return string(path, length);
+#else
+    error_code error;
+    filesystem::path path = filesystem::read_symlink("/proc/self/exe", error);
+    if (!error) return path.string();
+#endif
+    return argv0;
+}
+
+// Generates each size, runs it in a child process and writes every result to `outFile`
+// ("-" for stdout) as "json" or "csv"
+int benchmarkSuite(const string& program, const vector<long long>& sizes, const string& format, const string& outFile) {
+    error_code error;
+    filesystem::path dir = filesystem::temp_directory_path(error);
+    if (error) dir = ".";
+    // The process ID keeps two suites running at once from sharing files
+#ifdef _WIN32
+    string prefix = "c_excel_bench_" + to_string(GetCurrentProcessId()) + "_";
+#else
+    string prefix = "c_excel_bench_" + to_string(getpid()) + "_";
+#endif
+    string resultsFile = (dir / (prefix + "results.tsv")).string();
+    vector<SuiteResult> all;
+    for (long long rows : sizes) {
+        string csv = (dir / (prefix + to_string(rows) + ".csv")).string();
+        cerr << "Benchmarking " << rows << " rows..." << endl;
+        if (generateCsv(csv, rows) != 0) return 1;
+        remove(resultsFile.c_str());
+        string command = "\"" + program + "\" --bench-suite-run \"" + csv + "\" \"" + resultsFile + "\"";
+#ifdef _WIN32
+        command = "\"" + command + "\"";   // cmd.exe strips one pair of outer quotes
+#endif
+        int status = system(command.c_str());
+        remove(csv.c_str());
+        ifstream in(resultsFile);
+        string line;
+        while (getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            SuiteResult result{rows, "", 0, 0, 0};
+            char operation[64];
+            unsigned long long peak;
+            if (sscanf(line.c_str(), "%63s %lld %lf %llu", operation, &result.items, &result.seconds, &peak) != 4) continue;
+            result.operation = operation;
+            result.peakResident = peak;
+            all.push_back(result);
+        }
+        in.close();
+        remove(resultsFile.c_str());
+        if (status != 0) {
+            cerr << "Benchmark run failed for " << rows << " rows\n";
+            return 1;
+        }
+    }
+
+    ofstream file;
+    if (outFile != "-") {
+        file.open(outFile);
+        if (!file) {
+            cerr << "File cannot be opened: " << outFile << endl;
+            return 1;
+        }
+    }
+    ostream& out = outFile == "-" ? cout : file;
+    out.precision(10);
+    if (format == "csv") out << "rows,operation,items,seconds,ns_per_op,items_per_second,peak_rss_bytes\n";
+    else out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < all.size(); i++) {
+        const SuiteResult& r = all[i];
+        double nsPerOp = r.items ? r.seconds * 1e9 / r.items : 0;
+        double itemsPerSecond = r.seconds > 0 ? r.items / r.seconds : 0;
+        if (format == "csv")
+            out << r.rows << "," << r.operation << "," << r.items << "," << r.seconds << "," << nsPerOp << ","
+                << itemsPerSecond << "," << r.peakResident << "\n";
+        else
+            out << "    {\"rows\": " << r.rows << ", \"operation\": \"" << r.operation << "\", \"items\": " << r.items
+                << ", \"seconds\": " << r.seconds << ", \"ns_per_op\": " << nsPerOp << ", \"items_per_second\": "
+                << itemsPerSecond << ", \"peak_rss_bytes\": " << r.peakResident << "}" << (i + 1 < all.size() ? "," : "") << "\n";
+    }
+    if (format != "csv") out << "  ]\n}\n";
+    return out ? 0 : 1;
+}
+
+// Checks that a change log is not replayed onto an edited CSV: removes the first record,
+// deletes that record's line from the CSV (every later row ID shifts down by one) and
+// restarts. The log must be set aside; replaying it would remove the second record
+// instead. Runs with and without the snapshot, each run in a child process.
+int checkChangeLog(const string& program, const string& fileLocation) {
+    ifstream in(fileLocation, ios::binary);
+    string header, lines[2];
+    if (!getline(in, header) || !getline(in, lines[0]) || !getline(in, lines[1])) {
+        cerr << "Need at least two records in " << fileLocation << endl;
+        return 1;
+    }
+    string rest((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    in.close();
+    RowView rows[2];
+    for (int i = 0; i < 2; i++) {
+        string_view line(lines[i]), fields[CSV_COLUMNS];
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (!parseRowView(fields, splitLineView(line, fields, CSV_COLUMNS), rows[i])) {
+            cerr << "The first two records of " << fileLocation << " must be well-formed\n";
+            return 1;
+        }
+    }
+
+    error_code error;
+    filesystem::path dir = filesystem::temp_directory_path(error);
+    if (error) dir = ".";
+#ifdef _WIN32
+    string prefix = (dir / ("c_excel_check_" + to_string(GetCurrentProcessId()) + "_")).string();
+#else
+    string prefix = (dir / ("c_excel_check_" + to_string(getpid()) + "_")).string();
+#endif
+    string csv = prefix + "bank.csv", queries = prefix + "queries.txt", output = prefix + "output.txt";
+    auto cleanUp = [&] {
+        for (const string& file : {csv, snapshotPath(csv), logPath(csv), logPath(csv) + ".stale",
+                                   snapshotPath(csv) + ".stale", queries, output})
+            remove(file.c_str());
+    };
+    auto batch = [&](const string& query, bool useSnapshot) {
+        ofstream(queries, ios::binary) << query << "\n";
+        string command = "\"" + program + "\" --batch \"" + csv + "\" \"" + queries + "\""
+                       + (useSnapshot ? "" : " --no-snapshot") + " > \"" + output + "\" 2>&1";
+#ifdef _WIN32
+        command = "\"" + command + "\"";
+#endif
+        int status = system(command.c_str());
+        ifstream result(output, ios::binary);
+        string text((istreambuf_iterator<char>(result)), istreambuf_iterator<char>());
+        return status == 0 ? text : "";
+    };
+
+    bool ok = true;
+    for (bool useSnapshot : {true, false}) {
+        cleanUp();
+        ofstream(csv, ios::binary) << header << "\n" << lines[0] << "\n" << lines[1] << "\n" << rest;
+        batch("remove " + to_string(rows[0].cardNo) + " " + to_string(rows[0].pin), useSnapshot);
+        ofstream(csv, ios::binary | ios::trunc) << header << "\n" << lines[1] << "\n" << rest;
+        string found = batch("card " + to_string(rows[1].cardNo), useSnapshot);
+        bool setAside = filesystem::exists(logPath(csv) + ".stale", error);
+        bool kept = found.find(string(rows[1].name)) != string::npos;
+        cout << (useSnapshot ? "With snapshot:    " : "Without snapshot: ")
+             << (kept ? "second record kept" : "SECOND RECORD REMOVED") << ", "
+             << (setAside ? "log set aside" : "LOG NOT SET ASIDE") << "\n";
+        ok = ok && kept && setAside;
+    }
+    cleanUp();
+    cout << (ok ? "Change log check passed\n" : "Change log check FAILED\n");
+    return ok ? 0 : 1;
+}
+
+// Times the four list sorts (the quadratic ones only up to QUADRATIC_SORT_LIMIT rows)
+// and the radix engine by PIN, each from row order and checked against each other, then
+// the radix engine on the other numeric columns
+int benchmarkSorts(const string& fileLocation) {
+    beginBulkLoad();
+    if (!loadMappedFile(fileLocation)) return 1;
+    endBulkLoad();
+    int n = store.liveRows;
+    cout << "Sort benchmark: " << fileLocation << " (" << n << " rows)\n";
+    auto listOrder = [] {
+        vector<int> rows;
+        for (Node* p = head; p; p = p->next) rows.push_back(p->row);
+        return rows;
+    };
+    vector<int> expected = sortedRows(pinKey);
+    bool same = true;
+    auto run = [&](const char* label, auto sort) {
+        relinkInRowOrder();
+        auto start = chrono::steady_clock::now();
+        sort();
+        double seconds = secondsSince(start);
+        vector<int> order = listOrder();
+        // The in-place swaps reorder rows between nodes, so only the key order is compared
+        bool sorted = order.size() == expected.size();
+        for (size_t i = 0; sorted && i < order.size(); i++) sorted = store.pin[order[i]] == store.pin[expected[i]];
+        same = same && sorted;
+        cout << label << seconds * 1e3 << " ms, " << n / seconds << " rows/s" << (sorted ? "" : " (WRONG ORDER)") << "\n";
+    };
+    if (n <= QUADRATIC_SORT_LIMIT) {
+        run("Bubble sort:    ", [] { bubbleSortList(head); });
+        run("Selection sort: ", [] { selectionSortList(head); });
+        run("Insertion sort: ", [] { head = insertionSortList(head); restoreBackLinks(); });
+    } else cout << "(bubble, selection and insertion sort skipped above " << QUADRATIC_SORT_LIMIT << " rows)\n";
+    run("Merge sort:     ", [] { head = mergeSortList(head); restoreBackLinks(); });
+    run("Radix (PIN):    ", [] { relinkList(sortedRows(pinKey)); });
+    const pair<const char*, long long (*)(int)> columns[] = {
+        {"card number", cardKey}, {"credit limit", creditKey}, {"expiry", expiryKey}, {"billing day", billingKey}};
+    for (auto& [label, keyOf] : columns) {
+        auto start = chrono::steady_clock::now();
+        vector<int> rows = sortedRows(keyOf);
+        double seconds = secondsSince(start);
+        for (size_t i = 1; i < rows.size(); i++)
+            same = same && (keyOf(rows[i - 1]) < keyOf(rows[i]) || (keyOf(rows[i - 1]) == keyOf(rows[i]) && rows[i - 1] < rows[i]));
+        cout << "Radix (" << label << "): " << seconds * 1e3 << " ms, " << n / seconds << " rows/s\n";
+    }
+    cout << "Orders " << (same ? "agree" : "DIFFER") << "\n";
+    return same ? 0 : 1;
+}
+
+// Sorts the list order by `fields` with std::stable_sort comparing the record fields
+// directly, then with the multi-key engine on one worker and on every worker (at least
+// four, so the parallel merge is exercised even on one core), checking all three agree
+int benchmarkMultiKeySort(const string& fileLocation, const string& fields) {
+    vector<SortKey> spec;
+    if (!parseSortSpec(fields, spec)) {
+        cerr << "Unknown sort fields: " << fields << "\n";
+        return 1;
+    }
+    beginBulkLoad();
+    if (!loadMappedFile(fileLocation)) return 1;
+    endBulkLoad();
+    vector<int> rows = listRows();
+    cout << "Multi-key sort benchmark: " << fileLocation << " (" << rows.size() << " rows) by " << fields << "\n";
+    auto field = [](const SortKey& key, int row) -> tuple<string_view, long long> {
+        switch (key.field) {
+            case FIELD_NAME: return {store.str(store.name[row]), 0};
+            case FIELD_BANK: return {store.str(store.bank[row]), 0};
+            case FIELD_CARD: return {"", store.cardNo[row]};
+            case FIELD_EXPIRY: return {"", store.expiryMonths[row]};
+            case FIELD_BILLING: return {"", store.billingDate[row]};
+            case FIELD_PIN: return {"", store.pin[row]};
+            default: return {"", store.creditLimit[row]};
+        }
+    };
+    vector<int> expected = rows;
+    auto start = chrono::steady_clock::now();
+    stable_sort(expected.begin(), expected.end(), [&](int a, int b) {
+        for (const SortKey& key : spec) {
+            auto x = field(key, a), y = field(key, b);
+            if (x != y) return key.descending ? y < x : x < y;
+        }
+        return false;
+    });
+    double baseline = secondsSince(start);
+    cout << "std::stable_sort on fields: " << baseline << " s\n";
+    bool same = true;
+    for (int threads : {1, max(4, defaultThreadCount())}) {
+        start = chrono::steady_clock::now();
+        vector<int> sorted = multiKeySort(spec, rows, threads);
+        double seconds = secondsSince(start);
+        same = same && sorted == expected;
+        cout << "Multi-key engine, " << threads << " worker" << (threads > 1 ? "s" : "") << ": " << seconds << " s ("
+             << baseline / seconds << "x)\n";
+    }
+    cout << "Orders " << (same ? "agree" : "DIFFER") << "\n";
+    return same ? 0 : 1;
+}
+
+//prompt user
+// Reads a whole line, so names with spaces ("Diners Club") can be entered
+string readLine() {
+    string line;
+    cin >> ws;
+    getline(cin, line);
+    return line;
+}
+int main(int argc, char* argv[]) {
+    string fileLocation = "bank.csv";
+    if (argc >= 2 && string(argv[1]) == "--bench-ingest")
+        return benchmarkIngest(argc >= 3 ? argv[2] : fileLocation);
+    if (argc >= 2 && string(argv[1]) == "--bench-alloc")
+        return benchmarkAllocations(argc >= 3 ? argv[2] : fileLocation);
+    if (argc >= 2 && string(argv[1]) == "--bench-mst")
+        return benchmarkMST(argc >= 3 ? argv[2] : fileLocation, argc >= 4 ? atoll(argv[3]) : 10000000);
+    if (argc >= 2 && string(argv[1]) == "--bench-multisort")
+        return benchmarkMultiKeySort(argc >= 3 ? argv[2] : fileLocation, argc >= 4 ? argv[3] : "bank,expiry,card");
+    if (argc >= 2 && string(argv[1]) == "--bench-sort")
+        return benchmarkSorts(argc >= 3 ? argv[2] : fileLocation);
+    if (argc >= 2 && string(argv[1]) == "--bench-scan")
+        return benchmarkScans(argc >= 3 ? argv[2] : fileLocation);
+    if (argc >= 2 && string(argv[1]) == "--bench-cards")
+        return benchmarkCardLookups(argc >= 3 ? argv[2] : fileLocation);
+    if (argc >= 2 && string(argv[1]) == "--bench-suite") {
+        vector<long long> sizes;
+        string format = "json", outFile = "-";
+        for (int i = 2; i < argc; i++) {
+            string arg = argv[i];
+            if (arg == "--csv" || arg == "--json") format = arg.substr(2);
+            else if (arg == "--out" && i + 1 < argc) outFile = argv[++i];
+            else if (atoll(argv[i]) > 0) sizes.push_back(atoll(argv[i]));
+            else {
+                cerr << "Usage: " << argv[0] << " --bench-suite [--json|--csv] [--out <file>] [rows...]\n";
+                return 1;
+            }
+        }
+        if (sizes.empty()) sizes = {10000, 100000, 1000000};
+        return benchmarkSuite(executablePath(argv[0]), sizes, format, outFile);
+    }
+    if (argc >= 2 && string(argv[1]) == "--check-log")
+        return checkChangeLog(executablePath(argv[0]), argc >= 3 ? argv[2] : fileLocation);
+    if (argc >= 4 && string(argv[1]) == "--bench-suite-run")
+        return runSuiteSize(argv[2], argv[3]);
+    if (argc >= 2 && string(argv[1]) == "--generate") {
+        if (argc < 4) {
+            cerr << "Usage: " << argv[0] << " --generate <file.csv> <rows> [seed]\n";
+            return 1;
+        }
+        return generateCsv(argv[2], atoll(argv[3]), argc >= 5 ? strtoull(argv[4], nullptr, 10) : 1);
+    }
+    if (argc >= 2 && string(argv[1]) == "--batch") {
+        bool useSnapshot = !(argc >= 5 && string(argv[4]) == "--no-snapshot");
+        return runBatch(argc >= 3 ? argv[2] : fileLocation, argc >= 4 ? argv[3] : "-", useSnapshot);
+    }
+    if (argc >= 2) fileLocation = argv[1];
+    bool useSnapshot = !(argc >= 3 && string(argv[2]) == "--no-snapshot");
+    openStore(fileLocation, useSnapshot);
+    int choice = 0;
+    do {
         cout << "\n===== Bank Card Management System =====\n";
         cout << "1. Display all users\n";
         cout << "2. Display a specific user by name\n";
@@ -880,14 +4449,14 @@ int main() {
         cout << "6. Add User\n";
         cout << "7. BST Search by Card Number\n";
         cout << "8. AVL Search by Card Number\n";
-        cout << "9. Heap Extract Max Card\n";
+        cout << "9. Heap: top cards by card number\n";
         cout << "10. Dijkstra Path (Expiry Similarity)\n";
         cout << "11. Prim's MST (Billing Date Similarity)\n";
         cout << "12. Kruskal's MST (Billing Date Similarity)\n";
-        cout << "13. Open Addressing Search by PIN\n";
-        cout << "14. Chaining Search by PIN\n";
-        cout << "15. Display Open Addressing Table\n";
-        cout << "16. Display Chaining Table\n";
+        cout << "13. Hash Index Search by PIN\n";
+        cout << "14. Hash Index: all cards with a PIN\n";
+        cout << "15. Display Hash Index\n";
+        cout << "16. Display Hash Index Statistics\n";
         cout << "17. Bubble Sort by PIN\n";
         cout << "18. Selection Sort by PIN\n";
         cout << "19. Insertion Sort by PIN\n";
@@ -897,6 +4466,14 @@ int main() {
         cout << "23. DFS to find all customers of a bank\n";
         cout << "24. Linear search to find user by PIN\n";
         cout << "25. Binary search to find user by PIN\n";
+        cout << "26. Cache-optimized search by Card Number\n";
+        cout << "27. Find cards in a card number range\n";
+        cout << "28. Find cards expiring between two dates\n";
+        cout << "29. Heap: top cards by credit limit\n";
+        cout << "30. Compact the change log into the snapshot\n";
+        cout << "31. Show operation latencies and index health\n";
+        cout << "32. Radix Sort by a numeric column\n";
+        cout << "33. Sort by several fields\n";
         cout << "0. Exit\n";
         cout << "Select an option: ";
         cin >> choice;
@@ -905,7 +4482,7 @@ int main() {
         } else if (choice == 2) {
             string username;
             cout << "Enter name of user to search: \n";
-            cin>>username;
+            username = readLine();
             print(username);
         } else if (choice == 3) {
             long long cardNo;
@@ -916,9 +4493,11 @@ int main() {
             cin >> pin;
             removeUser(cardNo, pin);
         } else if (choice == 4) {
-            Node* node = getLastUser();
-            if (node)
-                cout << "Last added user: " << node->name << ", Card No: " << node->cardNo << ", Bank: " << node->bank << ", Expiry: " << node->expiryDate <<"\n";
+            int row = getLastUser();
+            if (row != -1) {
+                Node* node = store.node[row];
+                cout << "Last added user: " << node->name() << ", Card No: " << node->cardNo() << ", Bank: " << node->bank() << ", Expiry: " << node->expiryDate() <<"\n";
+            }
             else
                 cout << "No users found.\n";
         } else if (choice == 5) {
@@ -928,10 +4507,10 @@ int main() {
             cout<<"Enter user details:\n";
             cout<<"Enter name:\n";
             string name; 
-            cin>>name;
+            name = readLine();
             cout<<"Enter bank:\n";
             string bank;
-            cin>>bank;
+            bank = readLine();
             cout<<"Enter card number:\n";
             long long cardNo; 
             cin>>cardNo;
@@ -941,129 +4520,129 @@ int main() {
             cout<<"Enter card pin:\n";
             int pin; 
             cin>>pin;
+            cout<<"Enter credit limit:\n";
+            int creditLimit;
+            cin>>creditLimit;
             time_t now = time(nullptr);
-            addNode(name, bank, expiryDate, cardNo, localtime(&now)->tm_mday, pin);
+            addNode(name, bank, expiryDate, cardNo, localtime(&now)->tm_mday, pin, creditLimit);
             cout<<"Added successfully";
         } else if (choice == 7) {
             long long cardNo;
             cout << "Enter card number: ";
             cin >> cardNo;
-            Node* result = searchBST(bstRoot, cardNo);
-            if (result) cout << "Found: " << result->name << endl;
+            int result = timed(OP_SEARCH_BST, [&] { return searchBST(bstRoot, cardNo); });
+            if (store.isLive(result)) cout << "Found: " << store.node[result]->name() << endl;
             else cout << "Not found!\n";
         } else if (choice == 8) {
             long long cardNo;
             cout << "Enter card number: ";
             cin >> cardNo;
-            Node* result = searchAVL(avlRoot, cardNo);
-            if (result) cout << "Found: " << result->name << endl;
+            int result = timed(OP_SEARCH_AVL, [&] { return searchAVL(avlRoot, cardNo); });
+            if (store.isLive(result)) cout << "Found: " << store.node[result]->name() << endl;
             else cout << "Not found!\n";
         } else if (choice == 9) {
-            Node* maxNode = heap->extractMax();
-            if (maxNode) cout << "Max Card: " << maxNode->cardNo << " (" << maxNode->name << ")\n";
-            else cout << "Heap empty!\n";
+            printTopK(cardHeap);
         } else if (choice == 10) {
             string bank;
             long long src, dest;
             cout << "Enter bank name: ";
-            cin >> bank;
+            bank = readLine();
             cout << "Enter source card number: ";
             cin >> src;
             cout << "Enter destination card number: ";
             cin >> dest;
-            long long path = dijkstraPath(getNodesByBank(bank), src, dest);
+            long long path = timed(OP_DIJKSTRA, [&] { return dijkstraPath(getNodesByBank(bank), src, dest); });
             if (path == -1) cout << "Invalid cards or bank!\n";
+            else if (path == LLONG_MAX) cout << "No path: every card in this bank expires in the same month\n";
             else cout << "Total expiry difference: " << path << " months\n";
         } else if (choice == 11) {
             string bank;
             cout << "Enter bank name: ";
-            cin >> bank;
-            long long total = primMST(getNodesByBank(bank));
+            bank = readLine();
+            long long total = timed(OP_PRIM, [&] { return primMST(getNodesByBank(bank)); });
             cout << "Minimum total date difference: " << total << " days" << endl;
         } else if (choice == 12) {
             string bank;
             cout << "Enter bank name: ";
-            cin >> bank;
-            long long total = kruskalMST(getNodesByBank(bank));
+            bank = readLine();
+            long long total = timed(OP_KRUSKAL, [&] { return kruskalMST(getNodesByBank(bank)); });
             cout << "Minimum total date difference: " << total << " days" << endl;
         } else if (choice == 13) {
             int pin;
             cout << "Enter PIN: ";
             cin >> pin;
-            Node* result = searchOpenAddressing(pin);
-            if (result) 
-                cout << "Found: " << result->name << "\n";
+            int result = timed(OP_SEARCH_PIN_HASH, [&] { return pinIndex.find(pin); });
+            if (result != -1) 
+                cout << "Found: " << store.node[result]->name() << "\n";
             else 
                 cout << "Not found!\n";
         } else if (choice == 14) {
             int pin;
             cout << "Enter PIN: ";
             cin >> pin;
-            Node* result = searchInChain(pin);
-            if (result) 
-                cout << "Found: " << result->name << "\n";
-            else 
+            const int* results;
+            int count = timed(OP_SEARCH_PIN_HASH, [&] { return pinIndex.findAll(pin, &results); });
+            for (int i = 0; i < count; i++)
+                cout << "Found: " << store.node[results[i]]->name() << ", Card: " << store.cardNo[results[i]] << "\n";
+            if (count == 0)
                 cout << "Not found!\n";
         } else if (choice == 15) {
-            displayOpenAddressing();
+            displayPinIndex();
         } else if (choice == 16) {
-            displayChainTable();
+            displayPinIndexStats();
         } else if (choice == 17) {
-            bubbleSortList(head);
+            timed(OP_SORT_BUBBLE, [] { bubbleSortList(head); });
             cout << "List sorted using Bubble Sort\n";
         }
         else if (choice == 18) {
-            selectionSortList(head);
+            timed(OP_SORT_SELECTION, [] { selectionSortList(head); });
             cout << "List sorted using Selection Sort\n";
         }
         else if (choice == 19) {
-            head = insertionSortList(head);
+            timed(OP_SORT_INSERTION, [] {
+                head = insertionSortList(head);
+                restoreBackLinks();
+            });
             cout << "List sorted using Insertion Sort\n";
         }
         else if (choice == 20) {
-            head = mergeSortList(head);
+            timed(OP_SORT_MERGE, [] {
+                head = mergeSortList(head);
+                restoreBackLinks();
+            });
             cout << "List sorted using Merge Sort\n";
         }
         else if (choice == 21) {
             cout << "Current Sorted List:\n";
             Node* current = head;
             while (current) {
-                cout << "Name: " << current->name 
-                     << ", PIN: " << current->pin 
-                     << ", Card: " << current->cardNo << "\n";
+                cout << "Name: " << current->name() 
+                     << ", PIN: " << current->pin() 
+                     << ", Card: " << current->cardNo() << "\n";
                 current = current->next;
             }
         } else if(choice == 22) {
             string bank;
             cout << "Enter bank name: ";
-            cin >> bank;
-            vector<Node*> bankNodes = getNodesByBank(bank);
-            printBFS(bankNodes);
-            break;
+            bank = readLine();
+            printBFS(bankIndex.find(bank));
         } else if (choice == 23) {
             string bank;
             cout << "Enter bank name: ";
-            cin >> bank;
-            vector<Node*> bankNodes = getNodesByBank(bank);
-            printDFS(bankNodes);
-            break;
+            bank = readLine();
+            printDFS(bankIndex.find(bank));
         }   else if (choice == 24) {
                 int pin;
                 cout << "Enter PIN to search: ";
                 cin >> pin;
                 
-                int index = linearSearch(head, pin);
-                if (index != -1) {
-                    Node* current = head;
-                    for (int i = 0; i < index && current; i++) {
-                        current = current->next;
-                    }
-                    if (current) {
-                        cout << "Found at position " << index << ":\n";
-                        cout << "Name: " << current->name << "\n";
-                        cout << "Card: " << current->cardNo << "\n";
-                        cout << "Bank: " << current->bank << "\n";
-                    }
+                int row = timed(OP_SEARCH_PIN_LINEAR, [&] { return linearSearch(pin); });
+                if (row != -1) {
+                    Node* current = store.node[row];
+                    cout << "Found at row " << row << ":\n";
+                    cout << "Name: " << current->name() << "\n";
+                    cout << "Card: " << current->cardNo() << "\n";
+                    cout << "Bank: " << current->bank() << "\n";
                 } else {
                     cout << "PIN not found in the list.\n";
                 }
@@ -1072,23 +4651,73 @@ int main() {
                 int pin;
                 cout << "Enter PIN to search: ";
                 cin >> pin;
-                head = mergeSortList(head);
-                rebuildHashTables(); 
-                Array sortedArray(head);
-                int index = binarySearch(sortedArray, pin);
+                const vector<int>* sorted;
+                int index = timed(OP_SEARCH_PIN_BINARY, [&] {
+                    sorted = &pinView.sorted();
+                    return binarySearch(*sorted, pin);
+                });
                 if (index != -1) {
+                    Node* found = store.node[(*sorted)[index]];
                     cout << "Found at position " << index << ":\n";
-                    cout << "Name: " << sortedArray.nodes[index]->name << "\n";
-                    cout << "Card: " << sortedArray.nodes[index]->cardNo << "\n";
-                    cout << "Bank: " << sortedArray.nodes[index]->bank << "\n";
+                    cout << "Name: " << found->name() << "\n";
+                    cout << "Card: " << found->cardNo() << "\n";
+                    cout << "Bank: " << found->bank() << "\n";
                 } else {
                     cout << "PIN not found in the list.\n";
                 }
+            } else if (choice == 26) {
+                long long cardNo;
+                cout << "Enter card number: ";
+                cin >> cardNo;
+                int result = timed(OP_SEARCH_CARD_INDEX, [&] { return cardIndex.find(cardNo); });
+                if (result != -1) cout << "Found: " << store.node[result]->name() << endl;
+                else cout << "Not found!\n";
+            } else if (choice == 27) {
+                long long lo, hi;
+                cout << "Enter lowest and highest card number: ";
+                cin >> lo >> hi;
+                printRange(avlRoot, lo, hi, OP_RANGE_CARD);
+            } else if (choice == 28) {
+                cout << "Enter first expiry date (MM/YYYY): ";
+                int lo = parseExpiryMonths(readLine());
+                cout << "Enter last expiry date (MM/YYYY): ";
+                int hi = parseExpiryMonths(readLine());
+                if (lo < 0 || hi < 0) cout << "Invalid date!\n";
+                else printRange(expiryRoot, lo, hi, OP_RANGE_EXPIRY);
+            } else if (choice == 29) {
+                printTopK(creditHeap);
+            } else if (choice == 30) {
+                if (!wal.isOpen() || !useSnapshot) cout << "No change log is open.\n";
+                else if (compactLog(fileLocation, wal.base, wal.recordCount())) cout << "Change log compacted.\n";
+                else cout << "Compaction failed.\n";
+            } else if (choice == 31) {
+                writeMetrics(cout);
+            } else if (choice == 32) {
+                long long (*const columns[])(int row) = {pinKey, cardKey, creditKey, expiryKey, billingKey};
+                int column;
+                cout << "Sort by 1) PIN 2) Card Number 3) Credit Limit 4) Expiry Date 5) Billing Date: ";
+                cin >> column;
+                if (column < 1 || column > 5) cout << "Invalid column!\n";
+                else {
+                    timed(OP_SORT_RADIX, [&] { relinkList(sortedRows(columns[column - 1])); });
+                    cout << "List sorted using Radix Sort\n";
+                }
+            } else if (choice == 33) {
+                cout << "Fields, most significant first (name, bank, card, expiry, billing, pin, credit;\n"
+                        "-field sorts descending), e.g. bank,expiry,card: ";
+                string fields = readLine();
+                vector<SortKey> spec;
+                if (!parseSortSpec(fields, spec)) cout << "Unknown field!\n";
+                else {
+                    timed(OP_SORT_MULTI, [&] { relinkList(multiKeySort(spec, listRows())); });
+                    cout << "List sorted by " << fields << "\n";
+                }
             }else if (choice != 0) {
             cout << "Invalid choice! Please try again.\n";
         }
-        if (choice >= 17 && choice <= 20) rebuildHashTables();
+        // One flush per menu action, however many records it logged
+        wal.sync();
     } while (choice != 0);
-    delete heap;
+    wal.close();
     return 0;
 }
\ No newline at end of file